@@ -0,0 +1,148 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_LINALG_BATCHED_CHOLESKY_HPP_
+#define BOOM_LINALG_BATCHED_CHOLESKY_HPP_
+
+#include <vector>
+#include <LinAlg/Vector.hpp>
+#include <LinAlg/SpdMatrix.hpp>
+#include <distributions/rng.hpp>
+
+namespace BOOM{
+
+  // A collection of independent positive definite linear systems
+  // P[g] * x[g] = b[g], g = 0, ..., size() - 1, all of the same small
+  // dimension.  Hierarchical models solve one such system per group
+  // to draw the group level coefficients from their full conditional
+  // distribution N(P^{-1} b, P^{-1}).  When the dimension is small a
+  // separate Chol for each group spends most of its time on LAPACK
+  // call overhead and heap allocation rather than arithmetic.
+  //
+  // The systems are stored interleaved in blocks of batch_width
+  // groups, so that element (i, j) of every matrix in a block is
+  // contiguous.  The factorization and the triangular solves loop over
+  // the matrix elements on the outside and over the groups in a block
+  // on the inside, which lets the compiler vectorize across groups.
+  // Blocks are independent, so they can be divided among threads.
+  //
+  // Usage:
+  //   BatchedCholesky batch(dim, number_of_groups);
+  //   for (int g = 0; g < number_of_groups; ++g) {
+  //     batch.set_system(g, precision[g], precision_weighted_mean[g]);
+  //     batch.simulate_noise(g, rng);
+  //   }
+  //   batch.draw();
+  //   for (int g = 0; g < number_of_groups; ++g) {
+  //     beta[g] = batch.solution(g);
+  //   }
+  class BatchedCholesky {
+   public:
+    // The number of groups in each interleaved block.
+    static const int batch_width = 8;
+
+    BatchedCholesky();
+    BatchedCholesky(int dim, int number_of_systems);
+
+    // Change the dimension or the number of systems.  The contents of
+    // all systems are reset: each precision to the identity and each
+    // right hand side and noise vector to zero.
+    void resize(int dim, int number_of_systems);
+
+    int dim() const {return dim_;}
+    int size() const {return number_of_systems_;}
+
+    // The number of threads used by solve() and draw().
+    void set_number_of_threads(int n);
+
+    // Set system g.
+    // Args:
+    //   g:  The index of the system to set.
+    //   precision: The dim x dim positive definite matrix P[g].  Only
+    //     the lower triangle is used, as with Chol.
+    //   rhs:  The right hand side b[g].
+    void set_system(int g, const SpdMatrix &precision, const Vector &rhs);
+
+    // Fill the noise vector for system g with dim() standard normal
+    // deviates from rng.  Drawing the noise one group at a time lets
+    // the caller use each group's own random number generator, so
+    // the draws do not depend on the number of threads.
+    void simulate_noise(int g, RNG &rng);
+
+    // Factor each P[g] and set solution(g) to P[g]^{-1} b[g].
+    void solve();
+
+    // Factor each P[g] = L L^T and set solution(g) to a draw from
+    // N(P[g]^{-1} b[g], P[g]^{-1}), using the noise z[g] supplied by
+    // simulate_noise():  L^{-T} (L^{-1} b[g] + z[g]).
+    void draw();
+
+    // The solution for system g from the most recent call to solve()
+    // or draw().
+    Vector solution(int g) const;
+
+    // Whether P[g] was positive definite at the most recent call to
+    // solve() or draw().  solution(g) is meaningless if it was not.
+    bool positive_definite(int g) const {
+      return positive_definite_[g];
+    }
+
+    // True if every P[g] was positive definite at the most recent
+    // call to solve() or draw().
+    bool all_positive_definite() const;
+
+   private:
+    // Factor and solve the systems in blocks [first_block, end_block).
+    // Returns true.  See the TODO in LatentDataImputerWorker::impute
+    // for why the return value is not void.
+    bool process_blocks(int first_block, int end_block, bool add_noise);
+    void process(bool add_noise);
+
+    int number_of_blocks() const {
+      return (number_of_systems_ + batch_width - 1) / batch_width;
+    }
+
+    // The position of element i of the given vector (or element
+    // offset i of the given matrix) for group g in the interleaved
+    // storage, where 'stride' is the number of elements per group.
+    int position(int g, int i, int stride) const {
+      return ((g / batch_width) * stride + i) * batch_width
+          + g % batch_width;
+    }
+
+    int dim_;
+    int number_of_systems_;
+    int number_of_threads_;
+
+    // Interleaved storage.  precision_ and cholesky_ hold dim^2
+    // elements per group, in column major order.  The other arrays
+    // hold dim elements per group.
+    std::vector<double> precision_;
+    std::vector<double> cholesky_;
+    std::vector<double> rhs_;
+    std::vector<double> noise_;
+    std::vector<double> solution_;
+
+    // Not vector<bool>, whose elements share storage and so cannot be
+    // written by different threads.
+    std::vector<char> positive_definite_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_LINALG_BATCHED_CHOLESKY_HPP_
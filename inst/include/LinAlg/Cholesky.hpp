@@ -22,9 +22,25 @@
 #include <LinAlg/SpdMatrix.hpp>
 
 namespace BOOM{
+    // The Cholesky decomposition A = L L^T of a symmetric positive
+    // definite matrix A.  Only the lower triangle of A is used.
+    //
+    // Code that needs several of A^{-1} b, log |A|, A^{-1}, or a
+    // draw from N(mu, A^{-1}) should factor A once with a Chol and
+    // use it for all of them, rather than calling the SpdMatrix
+    // member functions, each of which factors A from scratch.  A Chol
+    // held as a member can be refactored with decompose() without
+    // reallocating its storage.
     class Chol{
     public:
+      // An empty decomposition, to be filled by decompose().
+      Chol();
       Chol(const Matrix &A);
+
+      // Factor A, reusing the storage from the previous factorization
+      // if A is the same size.  Returns is_pos_def().
+      bool decompose(const Matrix &A);
+
       uint nrow()const;
       uint ncol()const;
       uint dim()const;
@@ -32,6 +48,14 @@ namespace BOOM{
       Matrix getLT()const;
       Matrix solve(const Matrix &B)const;
       Vector solve(const Vector &b)const;
+      // b = A^{-1} b.
+      void solve_inplace(Vector &b)const;
+      // x = L * x.
+      void Lmult_inplace(Vector &x)const;
+      // x = L^{-1} x.
+      void Lsolve_inplace(Vector &x)const;
+      // x = L^{-T} x.  If x ~ N(0, I) then on output x ~ N(0, A^{-1}).
+      void LTsolve_inplace(Vector &x)const;
       SpdMatrix inv()const;  // inverse of A
       SpdMatrix original_matrix()const;
       double det()const;     // det(A)
@@ -0,0 +1,213 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_LINALG_FIXED_MATRIX_HPP_
+#define BOOM_LINALG_FIXED_MATRIX_HPP_
+
+#include <cmath>
+#include <sstream>
+#include <LinAlg/Matrix.hpp>
+#include <LinAlg/Vector.hpp>
+#include <LinAlg/VectorView.hpp>
+#include <cpputil/report_error.hpp>
+
+namespace BOOM{
+
+  // The largest dimension handled by the fixed size kernels in the
+  // dispatching functions at the bottom of this file.  Larger
+  // matrices go to BLAS and LAPACK.
+  const int max_fixed_matrix_dimension = 4;
+
+  // A matrix whose dimensions are known at compile time, stored in
+  // column major order on the stack.  Matrix and SpdMatrix keep their
+  // elements on the heap and hand most of their work to BLAS and
+  // LAPACK, which is the right choice for all but the smallest
+  // matrices.  State space models and mixture models do a lot of work
+  // with 1x1 through 4x4 blocks, where the heap allocation and the
+  // library call overhead exceed the arithmetic.  The loops in
+  // FixedMatrix have compile time bounds, so the compiler can unroll
+  // them completely.
+  template <int NROW, int NCOL>
+  class FixedMatrix {
+   public:
+    FixedMatrix() {
+      for (int i = 0; i < NROW * NCOL; ++i) data_[i] = 0;
+    }
+
+    // Copy the elements of m, which must be NROW x NCOL.
+    explicit FixedMatrix(const Matrix &m) {
+      if (m.nrow() != NROW || m.ncol() != NCOL) {
+        std::ostringstream err;
+        err << "A " << m.nrow() << " x " << m.ncol() << " Matrix cannot be "
+            << "converted to a " << NROW << " x " << NCOL << " FixedMatrix.";
+        report_error(err.str());
+      }
+      copy_from(m.data());
+    }
+
+    // Copy the elements of the NROW x NCOL column major array 'data'.
+    void copy_from(const double *data) {
+      for (int i = 0; i < NROW * NCOL; ++i) data_[i] = data[i];
+    }
+
+    // Write the elements into the NROW x NCOL column major array
+    // 'data'.
+    void copy_to(double *data) const {
+      for (int i = 0; i < NROW * NCOL; ++i) data[i] = data_[i];
+    }
+
+    Matrix to_Matrix() const {
+      return Matrix(NROW, NCOL, data_);
+    }
+
+    static int nrow() {return NROW;}
+    static int ncol() {return NCOL;}
+
+    double & operator()(int i, int j) {return data_[i + NROW * j];}
+    double operator()(int i, int j) const {return data_[i + NROW * j];}
+    double *data() {return data_;}
+    const double *data() const {return data_;}
+
+    // y = this * x.  x and y may refer to the same memory.
+    void multiply(VectorView y, const ConstVectorView &x) const {
+      double xx[NCOL];
+      for (int j = 0; j < NCOL; ++j) xx[j] = x[j];
+      for (int i = 0; i < NROW; ++i) {
+        double total = 0;
+        for (int j = 0; j < NCOL; ++j) total += (*this)(i, j) * xx[j];
+        y[i] = total;
+      }
+    }
+
+    // y = this->transpose() * x.  x and y may refer to the same memory.
+    void Tmult(VectorView y, const ConstVectorView &x) const {
+      double xx[NROW];
+      for (int i = 0; i < NROW; ++i) xx[i] = x[i];
+      for (int j = 0; j < NCOL; ++j) {
+        double total = 0;
+        for (int i = 0; i < NROW; ++i) total += (*this)(i, j) * xx[i];
+        y[j] = total;
+      }
+    }
+
+   private:
+    double data_[NROW * NCOL];
+  };
+
+  //======================================================================
+  // Lower triangular Cholesky factorization of a symmetric positive
+  // definite matrix.  Only the upper triangle of 'spd' is used,
+  // matching SpdMatrix::reflect().
+  //
+  // Args:
+  //   spd:  The matrix to be factored.
+  //   L: On output, the lower triangular Cholesky factor of spd,
+  //     with zeros above the diagonal.
+  //
+  // Returns:
+  //   true if spd is positive definite.  If false is returned the
+  //   contents of L are unspecified.
+  template <int N>
+  bool fixed_cholesky(const FixedMatrix<N, N> &spd, FixedMatrix<N, N> &L) {
+    for (int j = 0; j < N; ++j) {
+      double diagonal = spd(j, j);
+      for (int k = 0; k < j; ++k) diagonal -= L(j, k) * L(j, k);
+      if (!(diagonal > 0)) return false;
+      double root = std::sqrt(diagonal);
+      L(j, j) = root;
+      for (int i = j + 1; i < N; ++i) {
+        double value = spd(j, i);
+        for (int k = 0; k < j; ++k) value -= L(i, k) * L(j, k);
+        L(i, j) = value / root;
+      }
+      for (int i = 0; i < j; ++i) L(i, j) = 0;
+    }
+    return true;
+  }
+
+  // x = L * x, for lower triangular L.
+  template <int N>
+  void fixed_Lmult_inplace(const FixedMatrix<N, N> &L, VectorView x) {
+    for (int i = N - 1; i >= 0; --i) {
+      double total = 0;
+      for (int k = 0; k <= i; ++k) total += L(i, k) * x[k];
+      x[i] = total;
+    }
+  }
+
+  // x = L^{-1} x, for lower triangular L.
+  template <int N>
+  void fixed_Lsolve_inplace(const FixedMatrix<N, N> &L, VectorView x) {
+    for (int i = 0; i < N; ++i) {
+      double total = x[i];
+      for (int k = 0; k < i; ++k) total -= L(i, k) * x[k];
+      x[i] = total / L(i, i);
+    }
+  }
+
+  // x = L^{-T} x, for lower triangular L.
+  template <int N>
+  void fixed_LTsolve_inplace(const FixedMatrix<N, N> &L, VectorView x) {
+    for (int i = N - 1; i >= 0; --i) {
+      double total = x[i];
+      for (int k = i + 1; k < N; ++k) total -= L(k, i) * x[k];
+      x[i] = total / L(i, i);
+    }
+  }
+
+  // x = (L L^T)^{-1} x, where L is the Cholesky factor of a positive
+  // definite matrix.
+  template <int N>
+  void fixed_chol_solve_inplace(const FixedMatrix<N, N> &L, VectorView x) {
+    fixed_Lsolve_inplace(L, x);
+    fixed_LTsolve_inplace(L, x);
+  }
+
+  //======================================================================
+  // Functions that dispatch on a run time dimension.  Each requires
+  // all dimensions to be between 1 and max_fixed_matrix_dimension.
+
+  // Lower Cholesky factor of the n x n column major matrix 'spd',
+  // written to the n x n column major array L.  Only the upper
+  // triangle of spd is used, and zeros are written above the
+  // diagonal of L.  Returns true iff spd is positive definite.
+  bool fixed_cholesky(int n, const double *spd, double *L);
+
+  // y = A * x, where A is a column major nrow x ncol array.  x and y
+  // may refer to the same memory.
+  void fixed_multiply(int nrow, int ncol, const double *A,
+                      VectorView y, const ConstVectorView &x);
+
+  // y = A^T * x, where A is a column major nrow x ncol array.  x and
+  // y may refer to the same memory.
+  void fixed_Tmult(int nrow, int ncol, const double *A,
+                   VectorView y, const ConstVectorView &x);
+
+  // y = A * x, using the fixed size kernels if A is small enough and
+  // Matrix multiplication otherwise.  x and y may refer to the same
+  // memory.
+  void small_matrix_multiply(const Matrix &A,
+                             VectorView y,
+                             const ConstVectorView &x);
+  void small_matrix_Tmult(const Matrix &A,
+                          VectorView y,
+                          const ConstVectorView &x);
+
+}  // namespace BOOM
+
+#endif  // BOOM_LINALG_FIXED_MATRIX_HPP_
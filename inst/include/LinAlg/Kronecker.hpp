@@ -19,8 +19,103 @@
 #define BOOM_LIN_ALG_KRONECKER_HPP
 
 #include <LinAlg/Matrix.hpp>
+#include <LinAlg/SpdMatrix.hpp>
+#include <LinAlg/Vector.hpp>
+#include <distributions/rng.hpp>
 
 namespace BOOM{
+  class Chol;
+
+  // Returns the (dense) Kronecker product of A and B.
   Matrix Kronecker(const Matrix &A, const Matrix &B);
+
+  // The classes below represent the Kronecker product A (x) B through
+  // its factors, without forming the product.  If A is m x m and B is
+  // n x n then A (x) B is (mn) x (mn), so storing it costs O(m^2 n^2)
+  // memory and factoring it costs O(m^3 n^3) time.  The operations
+  // here work on the factors, at O(mn(m + n)) time per product or
+  // solve.
+  //
+  // Vectors of length mn are identified with n x m matrices by
+  // stacking columns, as in vec(X).  The central identity is
+  //   (A (x) B) vec(X) = vec(B X A^T),
+  // so each member function has a Matrix form (in terms of X) and a
+  // Vector form (in terms of vec(X)).  In the matrix normal
+  // distribution, vec(Y) ~ N(vec(Mu), Sigma (x) Omega) where Omega is
+  // the row variance and Sigma the column variance of Y.
+  class KroneckerProduct {
+   public:
+    KroneckerProduct(const Matrix &A, const Matrix &B);
+
+    uint nrow()const{return A_.nrow() * B_.nrow();}
+    uint ncol()const{return A_.ncol() * B_.ncol();}
+
+    // Returns vec(B X A^T) for X with B.ncol() rows and A.ncol() columns.
+    Matrix multiply(const Matrix &X)const;
+    Vector operator*(const Vector &v)const;
+
+    // Returns (A (x) B)^T vec(X) = vec(B^T X A).
+    Matrix Tmult(const Matrix &X)const;
+    Vector Tmult(const Vector &v)const;
+
+    // The explicit product.
+    Matrix dense()const;
+
+   private:
+    Matrix A_;
+    Matrix B_;
+  };
+
+  //======================================================================
+  // The Kronecker product of two symmetric positive definite matrices.
+  // Only the lower Cholesky factors L_A and L_B are stored.  The
+  // Cholesky factor of A (x) B is L_A (x) L_B, so solves, determinants
+  // and multivariate normal draws all reduce to triangular operations
+  // on the factors.
+  class SpdKroneckerProduct {
+   public:
+    // Reports an error if A or B is not positive definite.
+    SpdKroneckerProduct(const SpdMatrix &A, const SpdMatrix &B);
+    // Use existing decompositions of A and B.
+    SpdKroneckerProduct(const Chol &A, const Chol &B);
+
+    uint dim()const{return LA_.nrow() * LB_.nrow();}
+
+    // (A (x) B) vec(X) = vec(B X A).  X is dim(B) x dim(A).
+    Matrix multiply(const Matrix &X)const;
+    Vector operator*(const Vector &v)const;
+
+    // (A (x) B)^{-1} vec(X) = vec(B^{-1} X A^{-1}).
+    Matrix solve(const Matrix &X)const;
+    Vector solve(const Vector &v)const;
+
+    // log det(A (x) B) = dim(B) * log det(A) + dim(A) * log det(B).
+    double logdet()const;
+
+    // Multiply by the Cholesky factor L = L_A (x) L_B, or solve with
+    // its transpose.
+    //   Lmult:   vec(L_B X L_A^T)
+    //   LTsolve: vec(L_B^{-T} X L_A^{-1})
+    Matrix Lmult(const Matrix &X)const;
+    Matrix LTsolve(const Matrix &X)const;
+
+    // Draw Y with vec(Y) ~ N(vec(Mu), A (x) B), or with vec(Y) ~
+    // N(vec(Mu), (A (x) B)^{-1}) for rmvn_ivar.
+    Matrix rmvn(RNG &rng, const Matrix &Mu)const;
+    Matrix rmvn_ivar(RNG &rng, const Matrix &Mu)const;
+
+    // The explicit product.
+    SpdMatrix dense()const;
+
+   private:
+    Matrix LA_;
+    Matrix LB_;
+    double logdet_A_;
+    double logdet_B_;
+
+    void check_shape(const Matrix &X)const;
+    Matrix reshape(const Vector &v)const;
+  };
+
 }
 #endif// BOOM_LIN_ALG_KRONECKER_HPP
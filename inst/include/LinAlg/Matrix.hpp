@@ -55,6 +55,10 @@ namespace BOOM{
 
     explicit Matrix(const SubMatrix &rhs);
     explicit Matrix(const ConstSubMatrix &rhs);
+    Matrix(const Matrix &rhs) = default;
+    Matrix(Matrix &&rhs) = default;
+    Matrix & operator=(const Matrix &rhs) = default;
+    Matrix & operator=(Matrix &&rhs) = default;
 
     Matrix & operator=(const SubMatrix &);
     Matrix & operator=(const ConstSubMatrix &);
@@ -357,6 +361,25 @@ namespace BOOM{
     Matrix operator/(const double y, const Matrix &x);
     inline Matrix operator-(const Matrix &x){return -1*x;}
 
+    // Overloads taking a temporary Matrix operand write the result
+    // into the temporary's storage, as with the Vector operators.
+    Matrix operator+(Matrix &&x, const Matrix &y);
+    Matrix operator+(const Matrix &x, Matrix &&y);
+    Matrix operator+(Matrix &&x, Matrix &&y);
+    Matrix operator-(Matrix &&x, const Matrix &y);
+    Matrix operator-(const Matrix &x, Matrix &&y);
+    Matrix operator-(Matrix &&x, Matrix &&y);
+
+    Matrix operator+(Matrix &&x, double y);
+    Matrix operator+(double y, Matrix &&x);
+    Matrix operator-(Matrix &&x, double y);
+    Matrix operator-(double y, Matrix &&x);
+    Matrix operator*(Matrix &&x, double y);
+    Matrix operator*(double y, Matrix &&x);
+    Matrix operator/(Matrix &&x, double y);
+    Matrix operator/(double y, Matrix &&x);
+    Matrix operator-(Matrix &&x);
+
     // element-by-element operations
     //     Matrix operator+(const Matrix &m1, const Matrix &m2);
     //     Matrix operator-(const Matrix &m1, const Matrix &m2);
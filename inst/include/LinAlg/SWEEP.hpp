@@ -19,12 +19,16 @@
 #ifndef BOOM_SWEEP_HPP
 #define BOOM_SWEEP_HPP
 
+#include <list>
+#include <map>
 #include <vector>
 #include<BOOM.hpp>
 
 #include <LinAlg/Vector.hpp>
 #include <LinAlg/Matrix.hpp>
 #include <LinAlg/SpdMatrix.hpp>
+#include <LinAlg/Selector.hpp>
+#include <distributions/rng.hpp>
 
 namespace BOOM{
 
@@ -70,6 +74,95 @@ namespace BOOM{
 
     SpdMatrix & swept_matrix(){return S;}
     const SpdMatrix & swept_matrix()const{return S;}
+   private:
+    // Sweep (sign = 1) or reverse sweep (sign = -1) on element m.
+    void sweep_element(uint m, double sign);
+  };
+
+  //======================================================================
+  // Conditional distributions of a multivariate normal given different
+  // subsets of observed variables, for imputing missing data.  Data
+  // sets with missing values typically have only a few distinct
+  // patterns of missingness, shared by many observations.  Sweeping
+  // the variance matrix costs O(p^2) per observed variable, and the
+  // Cholesky factor of each conditional variance costs O(p^3), so this
+  // class does that work once per pattern rather than once per
+  // observation.
+  //
+  // Swept matrices are cached by pattern, up to a maximum number of
+  // patterns, with the least recently used pattern discarded first.
+  // A new pattern is computed from the cached pattern that differs
+  // from it in the fewest variables, by sweeping or reverse sweeping
+  // just those variables.
+  //
+  // Patterns are Selectors with 'true' marking observed variables.
+  class SweptVarianceCache {
+   public:
+    // Args:
+    //   Sigma:  The variance matrix of the multivariate normal.
+    //   max_patterns: The maximum number of patterns to cache.
+    explicit SweptVarianceCache(const SpdMatrix &Sigma,
+                                int max_patterns = 32);
+
+    // Replace the variance matrix, which empties the cache.
+    void set_variance(const SpdMatrix &Sigma);
+    const SpdMatrix &variance()const{return Sigma_;}
+
+    // The variance matrix swept on the observed variables.
+    const SweptVarianceMatrix & swept(const Selector &observed);
+
+    // The conditional mean of the missing elements of y given the
+    // observed elements.  Missing elements of y are ignored.
+    // Args:
+    //   y:  A full size vector.
+    //   mu:  The mean of the multivariate normal.
+    //   observed:  The pattern of observed elements of y.
+    Vector conditional_mean(const Vector &y, const Vector &mu,
+                            const Selector &observed);
+
+    // The conditional variance of the missing elements given the
+    // observed elements.
+    const SpdMatrix & conditional_variance(const Selector &observed);
+
+    // Impute the missing elements in each row of Y, by drawing from
+    // their conditional distribution given the observed elements.
+    // Rows are processed in groups that share a pattern, so the
+    // conditional means and draws for each group are computed with
+    // matrix multiplications.
+    //
+    // Args:
+    //   rng:  The random number generator for the draws.
+    //   Y:  A matrix with one observation per row.  On output the
+    //     missing elements are replaced by imputed values, and the
+    //     observed elements are unchanged.
+    //   mu:  The mean of the multivariate normal.
+    //   observed:  observed[i] is the pattern for row i of Y.
+    void impute_rows(RNG &rng, Matrix &Y, const Vector &mu,
+                     const std::vector<Selector> &observed);
+
+    // The number of patterns currently cached.
+    int number_of_patterns()const{return entries_.size();}
+
+   private:
+    struct Entry {
+      Selector observed;
+      SweptVarianceMatrix swept;
+      // Regression coefficients of the missing variables on the
+      // observed variables (xdim x ydim), the conditional variance of
+      // the missing variables, and its lower Cholesky factor.
+      Matrix beta;
+      SpdMatrix conditional_variance;
+      Matrix conditional_variance_cholesky;
+    };
+    typedef std::list<Entry> EntryList;
+
+    SpdMatrix Sigma_;
+    std::size_t max_patterns_;
+    // Most recently used first.
+    EntryList entries_;
+    std::map<Selector, EntryList::iterator> index_;
+
+    Entry & find(const Selector &observed);
   };
 }
 
@@ -34,6 +34,7 @@ namespace BOOM{
     template <class FwdIt>
     explicit SpdMatrix(FwdIt Beg, FwdIt End);
     SpdMatrix(const SpdMatrix &sm);  // reference semantics
+    SpdMatrix(SpdMatrix &&sm) = default;
 
     // Args:
     //   m: A Matrix object that happens to be symmetric and positive
@@ -45,6 +46,7 @@ namespace BOOM{
     SpdMatrix(const ConstSubMatrix &m, bool check = true);
 
     SpdMatrix & operator=(const SpdMatrix &); // value semantics
+    SpdMatrix & operator=(SpdMatrix &&rhs) = default;
     SpdMatrix & operator=(const Matrix &);
     SpdMatrix & operator=(const SubMatrix &);
     SpdMatrix & operator=(const ConstSubMatrix &);
@@ -159,6 +161,9 @@ namespace BOOM{
   SpdMatrix operator*(double x, const SpdMatrix &V);
   SpdMatrix operator*(const SpdMatrix &v, double x);
   SpdMatrix operator/(const SpdMatrix &v, double x);
+  SpdMatrix operator*(double x, SpdMatrix &&V);
+  SpdMatrix operator*(SpdMatrix &&V, double x);
+  SpdMatrix operator/(SpdMatrix &&V, double x);
 
   SpdMatrix Id(uint p);
 
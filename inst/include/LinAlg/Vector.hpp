@@ -26,6 +26,7 @@
 #include <vector>
 #include <boost/operators.hpp>
 #include <uint.hpp>
+#include <LinAlg/Workspace.hpp>
 #include <functional>
 
 namespace BOOM{
@@ -77,6 +78,12 @@ namespace BOOM{
 
     Vector(Vector &&v) = default;
 
+    // Inside a WorkspaceRegion the storage goes back to the region's
+    // pool instead of the heap.
+    ~Vector() {
+      if (workspace::any_regions_active()) workspace::release(*this);
+    }
+
     // This constructors works with arbitrary STL containers.
     template <typename NUMERIC, template <typename ELEM,
                                           typename ALLOC = std::allocator<ELEM>
@@ -86,6 +93,7 @@ namespace BOOM{
     {}
 
     Vector & operator=(const Vector &);  // value semantics
+    Vector & operator=(Vector &&rhs) = default;
     Vector & operator=(double);  // value semantics
     Vector & operator=(const VectorView &);
     Vector & operator=(const ConstVectorView &);
@@ -255,8 +263,54 @@ namespace BOOM{
   Vector operator/(const VectorView &x, const Vector &y);
   Vector operator/(const Vector &x, const VectorView &y);
 
+  // Overloads taking a temporary Vector operand write the result
+  // into the temporary's storage and return it, so a chained
+  // expression such as a + K * v - T * b allocates only for the
+  // matrix products, and not for each intermediate sum.
+  Vector operator+(Vector &&x, const Vector &y);
+  Vector operator+(const Vector &x, Vector &&y);
+  Vector operator+(Vector &&x, Vector &&y);
+  Vector operator+(Vector &&x, const VectorView &y);
+  Vector operator+(const VectorView &x, Vector &&y);
+  Vector operator+(Vector &&x, const ConstVectorView &y);
+  Vector operator+(const ConstVectorView &x, Vector &&y);
+
+  Vector operator-(Vector &&x, const Vector &y);
+  Vector operator-(const Vector &x, Vector &&y);
+  Vector operator-(Vector &&x, Vector &&y);
+  Vector operator-(Vector &&x, const VectorView &y);
+  Vector operator-(const VectorView &x, Vector &&y);
+  Vector operator-(Vector &&x, const ConstVectorView &y);
+  Vector operator-(const ConstVectorView &x, Vector &&y);
+
+  Vector operator*(Vector &&x, const Vector &y);
+  Vector operator*(const Vector &x, Vector &&y);
+  Vector operator*(Vector &&x, Vector &&y);
+  Vector operator*(Vector &&x, const VectorView &y);
+  Vector operator*(const VectorView &x, Vector &&y);
+  Vector operator*(Vector &&x, const ConstVectorView &y);
+  Vector operator*(const ConstVectorView &x, Vector &&y);
+
+  Vector operator/(Vector &&x, const Vector &y);
+  Vector operator/(const Vector &x, Vector &&y);
+  Vector operator/(Vector &&x, Vector &&y);
+  Vector operator/(Vector &&x, const VectorView &y);
+  Vector operator/(const VectorView &x, Vector &&y);
+  Vector operator/(Vector &&x, const ConstVectorView &y);
+  Vector operator/(const ConstVectorView &x, Vector &&y);
+
+  Vector operator+(Vector &&x, double a);
+  Vector operator+(double a, Vector &&x);
+  Vector operator-(Vector &&x, double a);
+  Vector operator-(double a, Vector &&x);
+  Vector operator*(Vector &&x, double a);
+  Vector operator*(double a, Vector &&x);
+  Vector operator/(Vector &&x, double a);
+  Vector operator/(double a, Vector &&x);
+
   // unary transformations
   Vector operator-(const Vector &x); // unary minus
+  Vector operator-(Vector &&x);
 
   using std::log;
   using std::exp;
@@ -266,26 +320,32 @@ namespace BOOM{
   Vector log(const Vector &x);
   Vector log(const VectorView &x);
   Vector log(const ConstVectorView &x);
+  Vector log(Vector &&x);
 
   Vector exp(const Vector &x);
   Vector exp(const VectorView &x);
   Vector exp(const ConstVectorView &x);
+  Vector exp(Vector &&x);
 
   Vector sqrt(const Vector &x);
   Vector sqrt(const VectorView &x);
   Vector sqrt(const ConstVectorView &x);
+  Vector sqrt(Vector &&x);
 
   Vector pow(const Vector &x, double p);
   Vector pow(const VectorView &x, double p);
   Vector pow(const ConstVectorView &x, double p);
+  Vector pow(Vector &&x, double p);
 
   Vector pow(const Vector &x, int p);
   Vector pow(const VectorView &x, int p);
   Vector pow(const ConstVectorView &x, int p);
+  Vector pow(Vector &&x, int p);
 
   Vector abs(const Vector &x);
   Vector abs(const VectorView &x);
   Vector abs(const ConstVectorView &x);
+  Vector abs(Vector &&x);
 
   inline int length(const Vector &x){return x.length();}
   inline double sum(const Vector &x){return x.sum();}
@@ -0,0 +1,104 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_LINALG_WORKSPACE_HPP_
+#define BOOM_LINALG_WORKSPACE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace BOOM{
+
+  // A WorkspaceRegion recycles the storage of the temporary Vector,
+  // Matrix and SpdMatrix objects created while it is in scope.  An
+  // MCMC iteration creates and destroys thousands of small
+  // temporaries (subsets of sufficient statistics from
+  // Selector::select, draws from rmvn, Kalman filter intermediates),
+  // and each one is a trip through malloc and free.
+  //
+  // While a region is active on a thread, a Vector destroyed on that
+  // thread hands its storage to a per-thread pool instead of freeing
+  // it, and a Vector created on that thread takes storage from the
+  // pool if a block of the right size is available.  Storage taken
+  // from the pool is ordinary heap memory, so objects created inside
+  // a region can safely outlive it.  The pool is freed when the
+  // outermost region on the thread is destroyed.
+  //
+  // Regions nest.  Only the outermost region on a thread has any
+  // effect.  Regions are per-thread, so each worker thread in a
+  // multi-threaded sampler needs its own.
+  //
+  // Usage:
+  //   {
+  //     WorkspaceRegion region;
+  //     model->sample_posterior();
+  //     WorkspaceRegion::Counts counts = region.counts();
+  //   }
+  //
+  // PriorPolicy::set_recycle_temporaries(true) does this for each call
+  // to sample_posterior().
+  class WorkspaceRegion {
+   public:
+    // Allocation counts for the Vector storage requested on this
+    // thread since the outermost region was created.
+    struct Counts {
+      // Storage reused from the pool.
+      long recycled;
+      // Storage that had to come from the heap.
+      long allocated;
+      // Storage returned to the pool by destroyed objects.
+      long returned;
+    };
+
+    WorkspaceRegion();
+    ~WorkspaceRegion();
+    WorkspaceRegion(const WorkspaceRegion &rhs) = delete;
+    WorkspaceRegion & operator=(const WorkspaceRegion &rhs) = delete;
+
+    // The allocation counts for this thread.
+    Counts counts() const;
+
+    // True if a WorkspaceRegion is active on this thread.
+    static bool active();
+  };
+
+  namespace workspace {
+    // The number of threads with an active WorkspaceRegion.  This lets
+    // the Vector constructors and destructor skip the thread local
+    // lookup in the usual case where no region exists.
+    extern std::atomic<int> threads_with_active_regions;
+
+    inline bool any_regions_active() {
+      return threads_with_active_regions.load(std::memory_order_relaxed)
+          > 0;
+    }
+
+    // If this thread has an active region, give v (which must be
+    // empty) capacity for at least n elements, from the pool if
+    // possible.
+    void reserve(std::vector<double> &v, std::size_t n);
+
+    // If this thread has an active region, move the storage of v to
+    // the pool, leaving v empty.
+    void release(std::vector<double> &v);
+  }  // namespace workspace
+
+}  // namespace BOOM
+
+#endif  // BOOM_LINALG_WORKSPACE_HPP_
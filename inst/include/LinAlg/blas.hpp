@@ -24,6 +24,14 @@
 // This is a wrapper around the blas functions used by BOOM.  BOOM
 // does not implement its own BLAS, but having BLAS functions wrapped
 // makes it relatively easy to switch BLAS implementations.
+//
+// The exception is very small problems.  A call to a Fortran BLAS
+// pays for argument checking, and a tuned or threaded BLAS pays for
+// dispatch and thread management, which is more than the arithmetic
+// in a 3-vector dot product or a 4x4 matrix multiply.  ddot, dgemv,
+// dgemm and dsyrk send problems below a run time threshold to simple
+// C++ loops written so the compiler can vectorize them.  Larger
+// problems go to whatever BLAS the library is linked against.
 
 namespace BOOM {
   namespace blas {
@@ -245,6 +253,36 @@ namespace BOOM {
 
     void initialize_blas_globals();
 
+    //----- Dispatch between the BLAS and the small problem kernels.
+
+    // Problem sizes are measured by the number of multiply-adds: N
+    // for ddot, M * N for dgemv, M * N * K for dgemm, and
+    // N * (N + 1) * K / 2 for dsyrk.  Problems smaller than the
+    // threshold for their routine use the C++ kernels.  A threshold
+    // of zero sends everything to the BLAS.
+    struct SmallKernelThresholds {
+      int ddot;
+      int dgemv;
+      int dgemm;
+      int dsyrk;
+    };
+
+    SmallKernelThresholds small_kernel_thresholds();
+
+    // The thresholds are global, and are not protected by a lock.
+    // Set them before starting any threads that do linear algebra.
+    void set_small_kernel_thresholds(const SmallKernelThresholds &thresholds);
+
+    // Times the small kernels against the BLAS for square problems of
+    // increasing size on this machine, and sets each threshold to the
+    // size where the BLAS becomes faster.  This takes a fraction of a
+    // second.  Like set_small_kernel_thresholds, it must not be
+    // called while other threads are doing linear algebra.
+    //
+    // Returns:
+    //   The new thresholds.
+    SmallKernelThresholds calibrate_small_kernel_thresholds();
+
   }  // namespace blas
 }  // namespace BOOM
 #endif // BOOM_BLAS_WRAPPER_HPP_
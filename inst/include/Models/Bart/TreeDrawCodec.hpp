@@ -0,0 +1,163 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_BART_TREE_DRAW_CODEC_HPP_
+#define BOOM_BART_TREE_DRAW_CODEC_HPP_
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <Models/Bart/Bart.hpp>
+
+namespace BOOM {
+  namespace Bart {
+
+    // A compact binary encoding of the trees in a sequence of MCMC
+    // draws from a BartModelBase.  The dense 3-column matrices
+    // produced by Tree::to_matrix() spend 24 bytes per node, most of
+    // which is redundant.  The encoding used here stores the nodes of
+    // each tree in the same (pre-)order as to_matrix(), but:
+    //
+    //   * Parent ids are not stored.  The topology is implied by the
+    //     pre-order listing of leaf/interior flags.
+    //   * Variable indices are stored as variable-length integers
+    //     ("varints"), which take a single byte for the first 127
+    //     variables.
+    //   * Cutpoints for variables with a discrete set of candidate
+    //     cutpoints are stored as a varint index into the cutpoint
+    //     values of the variable's SerializedVariableSummary.
+    //     Cutpoints that cannot be matched to a bin are stored as raw
+    //     doubles.
+    //   * Leaf means are stored as 8-byte doubles.
+    //
+    // Layout of the byte stream (all doubles are IEEE 754 doubles in
+    // little-endian byte order, so files are portable across hosts):
+    //
+    //   header:
+    //     8 bytes     magic string "BOOMBART"
+    //     varint      format version (currently 1)
+    //     varint      number of variable summaries
+    //     per summary:
+    //       varint    flags (bit 0: finalized, bit 1: is_continuous)
+    //       varint    variable_number
+    //       varint    strategy
+    //       varint    length of the data vector
+    //       doubles   the data vector
+    //   draws (repeated until the end of the stream):
+    //     varint      number of trees in the draw
+    //     per tree:
+    //       varint    number of bytes in the encoded tree
+    //       bytes     the encoded tree
+    //   encoded tree:
+    //     varint      number of nodes
+    //     per node (pre-order):
+    //       varint    0 for a leaf, otherwise 1 + variable index
+    //       leaf:     double (the mean parameter)
+    //       interior: varint  0 for a raw cutpoint, otherwise 1 + bin
+    //                 double  (raw cutpoint only)
+    //
+    // Because each draw is self-delimiting, draws can be appended to a
+    // stream as the sampler runs, and the stream can be read back
+    // without parsing the trees that are not needed.
+
+    //======================================================================
+    // Writes draws to an output stream as they are produced.  The
+    // stream should be opened in binary mode.
+    class TreeDrawWriter {
+     public:
+      // Args:
+      //   out: The stream where the encoded draws will be written.
+      //     The stream must outlive *this.
+      //   variable_summaries: The serialized variable summaries from
+      //     the model whose trees are being written.  They are written
+      //     to the stream header, and they determine the cutpoint
+      //     bins used to compress the cutpoints.
+      TreeDrawWriter(std::ostream &out,
+                     const std::vector<SerializedVariableSummary>
+                     &variable_summaries);
+
+      // Appends the current trees in 'model' as a single draw.
+      void write_draw(const BartModelBase &model);
+
+      // The number of draws written so far.
+      int number_of_draws() const {return number_of_draws_;}
+
+     private:
+      std::ostream &out_;
+      std::vector<SerializedVariableSummary> variable_summaries_;
+      int number_of_draws_;
+      std::string tree_buffer_;
+    };
+
+    //======================================================================
+    // Decodes draws written by a TreeDrawWriter.  The reader does not
+    // own or copy the encoded bytes, so they can be held in a
+    // memory-mapped file.  Construction scans the draw boundaries
+    // (which only requires reading a few varints per tree).  Trees are
+    // decoded only when they are requested.
+    class TreeDrawReader {
+     public:
+      // Args:
+      //   data: The encoded byte stream.  The memory must remain valid
+      //     for the lifetime of *this.
+      //   size: The number of bytes in 'data'.
+      TreeDrawReader(const char *data, std::size_t size);
+
+      int number_of_draws() const {return draw_offsets_.size();}
+      int number_of_trees(int draw) const;
+
+      // The variable summaries stored in the stream header, suitable
+      // for passing to BartModelBase::set_variable_summaries.
+      const std::vector<SerializedVariableSummary> &
+      variable_summaries() const {return variable_summaries_;}
+
+      // Returns the requested tree in the 3-column format produced by
+      // Tree::to_matrix().
+      Matrix tree_matrix(int draw, int which_tree) const;
+
+      // Rebuilds the requested tree, and only that tree.
+      Tree tree(int draw, int which_tree) const;
+
+      // Replaces the trees in 'model' with the trees from the
+      // requested draw.
+      void restore_draw(int draw, BartModelBase *model) const;
+
+      // The sum-of-trees prediction at x for the requested draw.  The
+      // trees are evaluated directly from their encoded bytes, without
+      // building any TreeNode objects.
+      double predict(int draw, const ConstVectorView &x) const;
+
+     private:
+      // Returns the position of the first byte of the requested tree
+      // (i.e. the position following the tree's length prefix).
+      const unsigned char *tree_position(int draw, int which_tree) const;
+      void check_draw(int draw) const;
+      double bin_value(int variable, unsigned long bin) const;
+
+      const unsigned char *begin_;
+      const unsigned char *end_;
+      std::vector<SerializedVariableSummary> variable_summaries_;
+      std::vector<std::size_t> draw_offsets_;
+    };
+
+  }  // namespace Bart
+}  // namespace BOOM
+
+#endif  // BOOM_BART_TREE_DRAW_CODEC_HPP_
@@ -89,6 +89,9 @@ namespace BOOM{
     virtual void set_sigsq(double sigsq)=0;
     double pdf(Ptr<Data> dp, bool logscale)const override;
     double pdf(const Data * dp, bool logscale)const override;
+    void fill_logp(const std::vector<Ptr<Data> > &data,
+                   int start,
+                   VectorView ans)const override;
     double Logp(double x, double &g, double &h, uint nd)const override;
     double Logp(const Vector & x, Vector &g, Matrix &h, uint nd)const;
 
@@ -19,6 +19,7 @@
 #ifndef BOOM_HIERARCHICAL_POISSON_REGRESSION_POSTERIOR_SAMPLER_HPP_
 #define BOOM_HIERARCHICAL_POISSON_REGRESSION_POSTERIOR_SAMPLER_HPP_
 
+#include <LinAlg/BatchedCholesky.hpp>
 #include <Models/PosteriorSamplers/PosteriorSampler.hpp>
 #include <Models/Glm/HierarchicalPoissonRegression.hpp>
 #include <Models/Glm/PosteriorSamplers/PoissonRegressionAuxMixSampler.hpp>
@@ -78,7 +79,9 @@ namespace BOOM {
     void draw() override;
 
     // impute_latent_data draws complete data sufficient statistics
-    // and regression coefficients for each data_model.
+    // and regression coefficients for each data_model.  The
+    // coefficients for all groups are drawn together, with a
+    // BatchedCholesky.
     void impute_latent_data();
     void compute_zero_mean_sufficient_statistics();
     void draw_mu_given_zero_mean_sufficient_statistics();
@@ -99,6 +102,10 @@ namespace BOOM {
     }
     const MvnBase * mu_prior()const{return mu_prior_.get();}
    private:
+    // Draw the latent data and the regression coefficients for each
+    // group.
+    void draw_group_coefficients();
+
     HierarchicalPoissonRegressionModel * model_;
     std::vector<Ptr<PoissonRegressionAuxMixSampler> > data_model_samplers_;
 
@@ -107,6 +114,10 @@ namespace BOOM {
 
     int nthreads_;
 
+    // The full conditional distributions of the coefficients for each
+    // group.
+    BatchedCholesky group_coefficients_;
+
     // Sufficient statistics for mu given alpha
     SpdMatrix xtx_;  // sum of the xtx sufficient statistics for each data model.
     Vector xtu_;     // sum of xtu() for each data model - xtx[i]*alpha[i]
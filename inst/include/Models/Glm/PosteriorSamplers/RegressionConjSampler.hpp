@@ -19,6 +19,7 @@
 #ifndef BOOM_REGRESSION_CONJUGATE_SAMPLER_HPP
 #define BOOM_REGRESSION_CONJUGATE_SAMPLER_HPP
 
+#include <LinAlg/Cholesky.hpp>
 #include <Models/Glm/RegressionModel.hpp>
 #include <Models/Glm/MvnGivenXandSigma.hpp>
 #include <Models/GammaModel.hpp>
@@ -55,6 +56,9 @@ namespace BOOM{
     Ptr<GammaModelBase> siginv_;
     Vector beta_tilde;
     SpdMatrix ivar;
+    // Cholesky decomposition of ivar, kept from set_posterior_suf()
+    // for the draw of beta.
+    Chol ivar_chol;
     double SS, DF;
     GenericGaussianVarianceSampler sigsq_sampler_;
     void set_posterior_suf();
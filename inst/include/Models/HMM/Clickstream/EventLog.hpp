@@ -0,0 +1,107 @@
+#ifndef BOOM_CLICKSTREAM_EVENT_LOG_HPP
+#define BOOM_CLICKSTREAM_EVENT_LOG_HPP
+
+#include <iosfwd>
+#include <vector>
+
+#include <Models/HMM/Clickstream/Stream.hpp>
+
+namespace BOOM {
+  namespace Clickstream{
+
+    // An EventLog is a compact, columnar alternative to a collection
+    // of Stream objects, intended for ingesting clickstream data in
+    // chunks that are too large to hold as Event/Session/Stream
+    // object graphs.  Each event is stored as a single int.  Sessions
+    // are stored as offsets into the event column, and streams as
+    // offsets into the session column, so the cost per event is
+    // 4 bytes plus a small per-session overhead.
+    //
+    // Every session ends with the EOS marker, which is the last event
+    // type (number_of_event_types() - 1), just as in a Session.
+    //
+    // Each stream carries an integer stream_id.  The same stream_id
+    // can appear in several logs (e.g. successive chunks of a data
+    // feed), which is how NestedHmm::add_sessions links newly arrived
+    // sessions to the history of a stream.
+    class EventLog {
+     public:
+      // Args:
+      //   number_of_event_types: The number of distinct event types,
+      //     including the EOS marker.
+      explicit EventLog(int number_of_event_types);
+
+      // Begin a new stream.  Sessions added by add_session() belong
+      // to the most recently started stream.
+      void start_stream(long stream_id);
+
+      // Append a session to the current stream.  If the final element
+      // of 'events' is not EOS then EOS is appended.  It is an error
+      // for EOS to appear anywhere else, or for an event type to be
+      // out of range.
+      void add_session(const std::vector<int> &events);
+
+      // Read sessions from a text stream, one session per line.  Each
+      // line contains a stream id followed by the event types in the
+      // session, separated by whitespace.  Consecutive lines with the
+      // same stream id belong to the same stream.
+      //
+      // Args:
+      //   in:  The stream to read from.
+      //   max_sessions: The maximum number of sessions to read.  A
+      //     negative value reads to the end of the input.  Reading a
+      //     large file a chunk at a time keeps memory bounded.
+      //
+      // Returns:
+      //   The number of sessions read.
+      int read(std::istream &in, int max_sessions = -1);
+
+      // Remove all streams, sessions, and events.
+      void clear();
+
+      int number_of_event_types()const{return number_of_event_types_;}
+      int eos()const{return number_of_event_types_ - 1;}
+      int number_of_streams()const{return stream_ids_.size();}
+      int number_of_sessions()const{return session_start_.size() - 1;}
+      int number_of_events()const{return events_.size();}
+
+      long stream_id(int stream)const{return stream_ids_[stream];}
+
+      // Sessions in 'stream' are numbered [first_session(stream),
+      // end_session(stream)) in the global session numbering.
+      int first_session(int stream)const{return stream_start_[stream];}
+      int end_session(int stream)const{return stream_start_[stream + 1];}
+
+      // Events in 'session' (a global session number) are
+      // [session_begin(session), session_end(session)), including the
+      // final EOS marker.
+      const int *session_begin(int session)const{
+        return events_.data() + session_start_[session];}
+      const int *session_end(int session)const{
+        return events_.data() + session_start_[session + 1];}
+
+      // The number of events, including EOS markers, in a stream.
+      int number_of_events(int stream)const{
+        return session_start_[end_session(stream)]
+            - session_start_[first_session(stream)];
+      }
+
+      // Build the Stream object for one stream in the log, for use
+      // with the parts of NestedHmm that require one.
+      // Args:
+      //   stream:  The index of the stream to materialize.
+      //   key:  The CatKey to use for the events in the stream.
+      Ptr<Stream> materialize(int stream, Ptr<CatKey> key)const;
+
+     private:
+      int number_of_event_types_;
+      std::vector<int> events_;
+      std::vector<int> session_start_;   // size number_of_sessions + 1
+      std::vector<int> stream_start_;    // size number_of_streams + 1
+      std::vector<long> stream_ids_;
+    };
+
+  }  // namespace Clickstream
+}  // namespace BOOM
+
+#endif  // BOOM_CLICKSTREAM_EVENT_LOG_HPP
@@ -12,6 +12,7 @@
 #include <distributions/rng.hpp>
 
 #include <Models/HMM/Clickstream/Stream.hpp>
+#include <Models/HMM/Clickstream/EventLog.hpp>
 
 namespace BOOM {
 
@@ -130,6 +131,65 @@ namespace BOOM {
     // called.
     void clear_session_type_distribution();
 
+    // Scoring a stream with fixed parameters.  The stream need not be
+    // part of the training data, and no data are assigned to the
+    // component models.  Hidden states are numbered as in
+    // encode_state(), and events are numbered consecutively across
+    // sessions, including the end of session markers.
+    //
+    // most_likely_states returns the Viterbi path: the joint
+    // configuration of session and event types with the highest
+    // posterior probability.
+    std::vector<int> most_likely_states(Ptr<Stream> stream)const;
+
+    // Returns a matrix with rows corresponding to events and columns
+    // to hidden states.  Row t is the marginal posterior distribution
+    // of the hidden state at event t.
+    Matrix state_probabilities(Ptr<Stream> stream)const;
+
+    //------------------------------------------------------------
+    // Streaming interface.  These methods work directly on the
+    // compact Clickstream::EventLog representation, and do not touch
+    // the Stream objects held as training data.  Emission
+    // probabilities come from the pi0() and Q() of the mixture
+    // components, so these methods bypass logp().
+
+    // Returns the log likelihood of one stream in 'log', computed
+    // from scratch.
+    double fwd(const Clickstream::EventLog &log, int stream)const;
+
+    // Incremental data augmentation for newly arrived sessions.  For
+    // each stream in 'log' the forward filter resumes from the state
+    // saved by the last call to add_sessions() with the same
+    // stream_id, or starts from the initial distribution if the
+    // stream_id is new.  Sufficient statistics for the new events are
+    // then added to the component models.  Earlier sessions are not
+    // re-filtered, so their contribution is fixed at what was known
+    // when they arrived.
+    //
+    // Sufficient statistics accumulate across calls.  Use
+    // complete_data_mode() or a posterior sampler to update the
+    // parameters, and clear_client_data() to start afresh.
+    //
+    // Args:
+    //   log:  The newly arrived sessions.
+    //   sample: If true, latent states are drawn from their
+    //     posterior distribution as in impute_latent_data().  If
+    //     false, expected sufficient statistics are added as in
+    //     fwd_bkwd().
+    //
+    // Returns:
+    //   The log likelihood of the new events given each stream's
+    //   history.
+    double add_sessions(const Clickstream::EventLog &log, bool sample = true);
+
+    // Forget the filter states saved by add_sessions().
+    void clear_stream_history();
+    int number_of_tracked_streams()const;
+
+    // Clear the sufficient statistics of the component models.
+    void clear_client_data();
+
    private:
     const int S0_;  // observed data size, including the EOS marker
     const int S1_;  // number of event types
@@ -162,8 +222,21 @@ namespace BOOM {
     mutable  Vector logpi0_;
     mutable  Vector logd_;
     const Vector one_;       // A vector of 1's
-    mutable  Matrix logQ1_;  // for the first obs in a session
-    mutable  Matrix logQ2_;  // for the subsequent observations
+    // Transition probabilities on the probability scale, for the
+    // scaled forward recursion.
+    mutable  Matrix Q1_;  // for the first obs in a session
+    mutable  Matrix Q2_;  // for the subsequent observations
+    mutable  Vector wsp_;
+
+    // Log emission probabilities for the streaming interface.  Column
+    // (previous + 1) * S0 + y holds the log probability of event y
+    // following event 'previous' in each hidden state, where
+    // previous = -1 marks the first event in a session.
+    mutable Matrix log_emission_;
+
+    // The filtered distribution of the hidden state at the last
+    // event seen by add_sessions(), indexed by stream_id.
+    std::map<long, Vector> stream_filter_state_;
 
     RNG rng_;
 
@@ -175,6 +248,15 @@ namespace BOOM {
     void start_thread_imputation();
     void start_thread_em();
     double initialize(Ptr<Event>)const;
+    double initialize_filter()const;
+    void fill_log_emission_table()const;
+    void fill_logd(int previous_event, int event)const;
+    double fwd(const Clickstream::EventLog &log, int stream,
+               const Vector *history)const;
+    void bkwd_sampling(const Clickstream::EventLog &log, int stream,
+                       bool continuing);
+    void bkwd_smoothing(const Clickstream::EventLog &log, int stream,
+                        bool continuing);
     void check_filter_size(int n)const;
     ConstVectorView get_hinit(const Vector &pi, int H)const;
     Vector get_Hinit(const Vector &pi)const;
@@ -185,7 +267,6 @@ namespace BOOM {
     double impute_latent_data_with_threads();
 
     double collect_threads();
-    void clear_client_data();
     void allocate_data_to_workers();
     void add_worker(Ptr<NestedHmm> w);
     void clear_workers();
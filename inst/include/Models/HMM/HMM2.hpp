@@ -77,6 +77,26 @@ class HiddenMarkovModel :
   void clear_prob_hist();
   Matrix report_state_probs(const DataSeriesType &ts)const;
 
+  // Scoring with fixed parameters.  These functions work on new data
+  // as well as the data owned by the model, and they do not modify
+  // the data assigned to the mixture components.
+  //
+  // most_likely_states returns the Viterbi path: the sequence of
+  // hidden states with the highest posterior probability.
+  // state_probabilities returns an n x S matrix whose row t is the
+  // marginal posterior distribution of the hidden state at time t.
+  std::vector<int> most_likely_states(const DataSeriesType &ts)const;
+  Matrix state_probabilities(const DataSeriesType &ts)const;
+
+  // Versions for scoring many series.  The series are divided among
+  // 'nthreads' threads, each with its own filter.
+  std::vector<std::vector<int> > most_likely_states(
+      const std::vector<Ptr<DataSeriesType> > &series,
+      int nthreads = 1)const;
+  std::vector<Matrix> state_probabilities(
+      const std::vector<Ptr<DataSeriesType> > &series,
+      int nthreads = 1)const;
+
   const Vector &pi0() const;
   const Matrix &Q() const;
   void set_pi0(const Vector &Pi0);
@@ -105,6 +125,13 @@ class HiddenMarkovModel :
   std::vector<Ptr<HmmDataImputer> > workers_;
 
   double impute_latent_data_with_threads();
+
+  // Fills *paths (if non-NULL) with the Viterbi path and *probs (if
+  // non-NULL) with the posterior state probabilities for each series.
+  void score_series(const std::vector<Ptr<DataSeriesType> > &series,
+                    int nthreads,
+                    std::vector<std::vector<int> > *paths,
+                    std::vector<Matrix> *probs)const;
 };
 //----------------------------------------------------------------------
 
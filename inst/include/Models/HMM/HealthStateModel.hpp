@@ -113,8 +113,11 @@ namespace BOOM{
     void fill_logp(Ptr<HealthStateData>);
     void fill_logp(Ptr<HealthStateData>, Vector &logp)const;
 
-    void fill_logQ(Ptr<HealthStateData>);
-    void fill_logQ(Ptr<HealthStateData>, Matrix &logQ)const;
+    // Fill Q_ with the transition probability matrix governing the
+    // transition to the given data point, which mixes the matrices
+    // for the old and new treatments if the treatment changed.
+    void fill_Q(Ptr<HealthStateData>);
+    void fill_Q(Ptr<HealthStateData>, Matrix &Q)const;
 
     int sample_treatment(Ptr<HealthStateData>,
                          uint previous_state,
@@ -127,7 +130,8 @@ namespace BOOM{
     double loglike_;
     double logpost_;
     mutable Vector logp_;
-    mutable Matrix logQ_;
+    mutable Matrix Q_;
+    mutable Vector wsp_;
 
     std::vector<Mat> P_;  // joint distribution of state in FB
     mutable Vector pi_;    // marginal distribution of state in FB
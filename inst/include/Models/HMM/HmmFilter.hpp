@@ -46,19 +46,83 @@ class HmmFilter
 
   double initialize(const Data *);
   double loglike(const std::vector<Ptr<Data> > & );
+
+  // Returns the total log likelihood of several independent series.
+  // The forward recursions for all the series are advanced together,
+  // so each step is a single matrix-matrix product against the
+  // transition matrix.
+  double loglike(const std::vector<const std::vector<Ptr<Data> > *> &);
   double fwd(const std::vector<Ptr<Data> > & );
   void bkwd_sampling(const std::vector<Ptr<Data> > &);
   void bkwd_sampling_mt(const std::vector<Ptr<Data> > &,
                         RNG & eng);
   virtual void allocate(Ptr<Data>, uint);
   virtual Vector state_probs(Ptr<Data>)const;
+
+  // Returns the most likely sequence of hidden states (the Viterbi
+  // path) given the data in dv and the current model parameters.
+  // Does not modify the data assigned to the models.
+  std::vector<int> most_likely_states(const std::vector<Ptr<Data> > &dv);
+
+  // Returns an n x S matrix whose row t is the posterior distribution
+  // of the hidden state at time t, given all the data in dv and the
+  // current model parameters.  Does not modify the data assigned to
+  // the models.
+  Matrix state_probabilities(const std::vector<Ptr<Data> > &dv);
+
+  // Storing the S x S transition distribution for every time point
+  // takes n * S^2 doubles.  If that would exceed the memory budget
+  // (in bytes) then fwd() only stores the forward probabilities at
+  // checkpoints spaced about sqrt(n) apart, and the backward passes
+  // recompute the transition distributions one segment at a time.
+  // This costs roughly one extra forward pass.  Recomputation is
+  // deterministic, so the results are identical to the full-storage
+  // algorithm.  The default budget is 512MB.
+  void set_memory_budget(double bytes);
+  bool using_checkpoints()const{return checkpoint_interval_ > 0;}
+
  protected:
+  // Returns the distribution of (h[i-1], h[i]) given data up to time
+  // i, as computed by fwd().  The backward passes call this with
+  // decreasing values of i.  The returned reference is only valid
+  // until the next call.
+  Matrix & transition_distribution(const std::vector<Ptr<Data> > &dv,
+                                   uint i);
+
   std::vector<Ptr<MixtureComponent> > models_;
   std::vector<Mat> P;
   Vector pi, logp, logpi, one;
-  Matrix logQ;
+  Matrix Q;
   Ptr<MarkovModel> markov_;
 
+ private:
+  void recompute_segment(const std::vector<Ptr<Data> > &dv, int segment);
+  void compute_logp(const Data *dp, Vector &ans)const;
+  // Fills the first nrows rows of logd_block_ with the log density of
+  // dv[start], ..., dv[start + nrows - 1] under each state, using one
+  // MixtureComponent::fill_logp call per state.
+  void fill_log_densities(const std::vector<Ptr<Data> > &dv,
+                          uint start, uint nrows);
+
+  double memory_budget_;
+  // The number of time points between checkpoints.  Zero means every
+  // transition distribution is stored in P.
+  int checkpoint_interval_;
+  // checkpoints_[k] is the filtered state distribution at time
+  // k * checkpoint_interval_.
+  std::vector<Vector> checkpoints_;
+  // Transition distributions for time points k*B+1 .. (k+1)*B, where
+  // k is current_segment_ and B is checkpoint_interval_.
+  std::vector<Matrix> segment_;
+  int current_segment_;
+  Vector segment_pi_;
+  Vector segment_logp_;
+  // Work space for fwd_1_scaled.
+  Vector wsp_;
+  Matrix logd_block_;
+  // Log transition probabilities, used by most_likely_states().
+  Matrix logQ_;
+
 };
 //----------------------------------------------------------------------
 class HmmSavePiFilter
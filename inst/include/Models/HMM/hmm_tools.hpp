@@ -18,6 +18,8 @@
 #ifndef BOOM_HMM_TOOLS_HPP
 #define BOOM_HMM_TOOLS_HPP
 #include <LinAlg/Types.hpp>
+#include <LinAlg/Vector.hpp>
+#include <vector>
 
 namespace BOOM{
 
@@ -25,5 +27,65 @@ namespace BOOM{
 		 const Vector &one);
     void bkwd_1(Vector &pi, Matrix &P, Vector & wsp, const Vector &one);
 
+    // Same inputs and outputs as fwd_1, but the recursion is carried
+    // out on the probability scale (Rabiner scaling), using the
+    // transition probability matrix Q instead of its log.  This
+    // needs S calls to exp() per step instead of S^2 calls to exp()
+    // and S calls to log().  If the scaled probabilities underflow
+    // the computation falls back to fwd_1.  wsp is work space.
+    double fwd_1_scaled(Vector &pi, Matrix &P, const Matrix &Q,
+                        const Vector &logd, const Vector &one, Vector &wsp);
+
+    // Advances several independent sequences governed by the same
+    // transition matrix by one step, without storing the joint
+    // transition distributions.  Row k of Pi is the filtered
+    // distribution of sequence k.  Row k of logD holds the log
+    // densities of the next observation in sequence k under each
+    // state.  The predictive distributions for all the sequences are
+    // computed by a single matrix-matrix product Pi * Q.  On exit Pi
+    // holds the updated filtered distributions, and loglike[k] has
+    // been incremented by log p(y[t] | y[1..t-1]) for sequence k.
+    void fwd_1_batch(Matrix &Pi, const Matrix &Q, const Matrix &logD,
+                     Vector &loglike);
+
+    // The max-product (Viterbi) recursion for the most likely sequence
+    // of hidden states.  The log transition matrix is supplied at each
+    // step, so it may vary over time (e.g. at session boundaries).
+    // Storage is one back-pointer per (time, state) pair.
+    class ViterbiRecursion {
+     public:
+      // Start a new sequence.
+      // Args:
+      //   log_initial: log p(h[0] = s, y[0]) for each state s.
+      void initialize(const Vector &log_initial);
+
+      // Advance the recursion by one time step.
+      // Args:
+      //   logQ: logQ(r, s) is the log probability of a transition
+      //     from state r to state s.  It may contain -infinity.
+      //   logd: logd[s] is the log density of the new observation
+      //     given state s.
+      void update(const Matrix &logQ, const Vector &logd);
+
+      // The state sequence maximizing the joint density of the states
+      // and the data seen so far.
+      std::vector<int> most_likely_path()const;
+
+      // The log of the joint density of the most likely path and the
+      // data.
+      double log_probability()const;
+
+     private:
+      int nstates_;
+      int ntimes_;
+      // delta_[s] is the largest log joint density of any path ending
+      // in state s.
+      Vector delta_;
+      Vector next_;
+      // backpointers_[(t - 1) * nstates_ + s] is the most likely state
+      // at time t-1, given state s at time t.
+      std::vector<int> backpointers_;
+    };
+
 }
 #endif// BOOM_HMM_TOOLS_HPP
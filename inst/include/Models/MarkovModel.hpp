@@ -38,6 +38,8 @@
 #include <LinAlg/Types.hpp>
 #include <LinAlg/Vector.hpp>
 #include <LinAlg/Matrix.hpp>
+#include <distributions/AliasTable.hpp>
+#include <distributions/rng.hpp>
 
 
 //=====================================================================
@@ -94,6 +96,9 @@ namespace BOOM{
     void clear() override{ trans_=0.0; init_=0.0; }
     void Update(const MarkovData &) override;
     void add_mixture_data(Ptr<MarkovData>, double prob);
+    // Adds 'prob' to the transition count (then, now), or to the
+    // initial count for 'now' if 'then' is negative.
+    void add_mixture_data(int then, int now, double prob);
     void add_transition_distribution(const Matrix &P);
     void add_initial_distribution(const Vector &pi);
     void add_transition(uint from, uint to);
@@ -237,12 +242,32 @@ namespace BOOM{
     double loglike(const Vector &serialized_params)const override;
     Vector stat_dist()const;
 
+    // Simulate the chain.  Draws use alias tables built from pi0 and
+    // from the rows of Q, so each draw costs O(1) regardless of the
+    // size of the state space.  The tables are built the first time
+    // they are needed and kept until the parameters change.
+    uint simulate_initial_state(RNG &rng)const;
+    // A draw of the state following state 'from'.
+    uint simulate_transition(RNG &rng, uint from)const;
+    // A realization of the chain with the given number of time points.
+    std::vector<uint> simulate(int length, RNG &rng)const;
+
   protected:
     virtual void resize(uint S);
   private:
     Ptr<MarkovData> dpp;  // data point prototype
     enum Pi0Status{Free, Uniform, Stationary, Known};
     Pi0Status pi0_status;
+
+    // Cached samplers for simulation, invalidated by observers on the
+    // parameters.
+    mutable AliasTable initial_state_sampler_;
+    mutable bool initial_state_sampler_current_ = false;
+    mutable std::vector<AliasTable> transition_samplers_;
+    mutable std::vector<bool> transition_samplers_current_;
+    void set_observers();
+    void observe_pi0(){initial_state_sampler_current_ = false;}
+    void observe_Q();
   };
 
 
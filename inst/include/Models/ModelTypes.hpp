@@ -24,6 +24,7 @@
 #include <distributions/rng.hpp>
 #include <LinAlg/Vector.hpp>
 #include <LinAlg/Matrix.hpp>
+#include <LinAlg/VectorView.hpp>
 
 namespace BOOM {
 
@@ -210,6 +211,15 @@ namespace BOOM {
   class MixtureComponent : virtual public Model {
    public:
     virtual double pdf(const Data *, bool logscale)const = 0;
+
+    // Fills ans[i] with the log density of data[start + i], for i = 0,
+    // ..., ans.size() - 1.  Missing observations get log density 0.
+    // The default implementation calls pdf() once per observation.
+    // Models with simple densities override it to look up their
+    // parameters once and evaluate the whole block in a tight loop.
+    virtual void fill_logp(const std::vector<Ptr<Data> > &data,
+                           int start,
+                           VectorView ans)const;
     MixtureComponent * clone() const override = 0;
   };
 
@@ -96,6 +96,9 @@ namespace BOOM{
     void mle() override;
     double pdf(const Data * dp, bool logscale) const override;
     double pdf(Ptr<Data> dp, bool logscale) const;
+    void fill_logp(const std::vector<Ptr<Data> > &data,
+                   int start,
+                   VectorView ans)const override;
     void add_mixture_data(Ptr<Data>, double prob);
 
     uint simdat()const;
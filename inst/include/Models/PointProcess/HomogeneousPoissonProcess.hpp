@@ -87,6 +87,7 @@ namespace BOOM{
     // Ptr<PointProcess> data element.
     void add_data_raw(int incremental_events, double incremental_duration);
     void add_data_raw(const PointProcess &);
+    void add_data_raw(const PackedPointProcess &data) override;
     void add_exposure_window(const DateTime &t0,
                                    const DateTime &t1) override;
     void add_event(const DateTime &t) override;
@@ -169,10 +169,30 @@ namespace BOOM{
       // by the presence or absence of the 'source' argument to
       // 'evaluate'.
       double conditional_cumulative_hazard(const HmmState *state, int t)const;
-     private:
-      // Returns the position of 'process' in processes_;
+
+      // Returns the position of 'process' in processes_.  The integer
+      // ids can be resolved once, ahead of time, and used with the
+      // accessors below to avoid hashing a pointer on each call.
       int process_id(const PoissonProcess *process)const;
 
+      // The cumulative hazard of process 'process_id' between events
+      // t-1 and t.
+      double cumulative_hazard(int process_id, int t)const {
+        return cumulative_hazard_(process_id, t);
+      }
+
+      // log_event_rate(process, t) + mixture_log_likelihood(process, t)
+      // for process 'process_id'.
+      double log_event_density(int process_id, int t)const {
+        double ans = log_event_rate_(process_id, t);
+        if(!minimal_mixture_components_.empty()){
+          ans += logp_(mixture_component_id_[process_id], t);
+        }
+        return ans;
+      }
+
+     private:
+
       const double neginf_;
       std::vector<PoissonProcess *> processes_;
 
@@ -207,6 +227,97 @@ namespace BOOM{
       Matrix logp_;
     };
 
+    //----------------------------------------------------------------------
+    // A compressed sparse row (CSR) description of the transitions
+    // that are possible among a set of HmmStates.  Most pairs of
+    // states cannot communicate, so the filter only stores and
+    // visits the legal transitions.  The ProcessInfo ids of the
+    // processes involved in each state and transition are resolved
+    // when the graph is built.
+    //
+    // Transition k moves from state from(k) to state to(k).  The
+    // transitions out of state r are numbered consecutively from
+    // outgoing_begin(r) to outgoing_end(r) - 1, in order of their
+    // destination.  The transitions into state s are
+    // incoming_transition(j) for j in [incoming_begin(s),
+    // incoming_end(s)), in order of their origin.
+    class TransitionGraph {
+     public:
+      TransitionGraph();
+
+      // Args:
+      //   states: The HMM states, with id_number() giving each
+      //     state's position in the vector.
+      //   process_info: The ProcessInfo object used to resolve
+      //     process ids.
+      TransitionGraph(const std::vector<Ptr<HmmState> > &states,
+                      const ProcessInfo &process_info);
+
+      int number_of_states()const {return outgoing_start_.size() - 1;}
+      int number_of_transitions()const {return to_.size();}
+
+      int from(int k)const {return from_[k];}
+      int to(int k)const {return to_[k];}
+      int outgoing_begin(int r)const {return outgoing_start_[r];}
+      int outgoing_end(int r)const {return outgoing_start_[r + 1];}
+
+      int incoming_begin(int s)const {return incoming_start_[s];}
+      int incoming_end(int s)const {return incoming_start_[s + 1];}
+      int incoming_transition(int j)const {return incoming_[j];}
+
+      // The processes that could be responsible for transition k are
+      // culprit(j) for j in [culprits_begin(k), culprits_end(k)).
+      int culprits_begin(int k)const {return culprit_start_[k];}
+      int culprits_end(int k)const {return culprit_start_[k + 1];}
+      PoissonProcess *culprit(int j)const {return culprits_[j];}
+
+      // Returns the index of the transition from state r to state s,
+      // or -1 if no such transition is possible.
+      int find(int r, int s)const;
+
+      // The sum of the cumulative hazards of the processes active in
+      // state r between events t-1 and t.  Same as
+      // process_info.conditional_cumulative_hazard(state r, t).
+      double cumulative_hazard(int r,
+                               int t,
+                               const ProcessInfo &process_info)const;
+
+      // The log of the event rate (times mark density) for the event
+      // at time t, summed over the processes that could produce
+      // transition k.  Same as
+      // MMPP::conditional_event_loglikelihood(t, from, to, info).
+      // Args:
+      //   wsp:  Workspace, resized as needed.
+      double event_loglikelihood(int k,
+                                 int t,
+                                 const ProcessInfo &process_info,
+                                 Vector &wsp)const;
+
+      // The log density of process culprit(j) producing the event at
+      // time t.
+      double culprit_log_density(int j,
+                                 int t,
+                                 const ProcessInfo &process_info)const {
+        return process_info.log_event_density(culprit_ids_[j], t);
+      }
+
+     private:
+      std::vector<int> outgoing_start_;
+      std::vector<int> from_;
+      std::vector<int> to_;
+      std::vector<int> incoming_start_;
+      std::vector<int> incoming_;
+
+      std::vector<int> culprit_start_;
+      std::vector<PoissonProcess *> culprits_;
+      std::vector<int> culprit_ids_;
+
+      // The ProcessInfo ids of the processes active in state r are
+      // active_ids_[j] for j in [active_start_[r], active_start_[r+1]).
+      std::vector<int> active_start_;
+      std::vector<int> active_ids_;
+    };
+
   } // namespace MmppHelper
 
   //======================================================================
@@ -246,8 +357,13 @@ namespace BOOM{
     typedef MmppHelper::HmmState HmmState;
     typedef MmppHelper::ProcessInfo ProcessInfo;
     typedef MmppHelper::SourceVector SourceVector;
+    typedef MmppHelper::TransitionGraph TransitionGraph;
 
     MarkovModulatedPoissonProcess();
+
+    // The copy has its own clones of the component processes and
+    // mixture components, connected in the same way as in rhs.  Data
+    // pointers are shared.  Worker threads are not copied.
     MarkovModulatedPoissonProcess(const MarkovModulatedPoissonProcess &rhs);
     MarkovModulatedPoissonProcess * clone() const override;
 
@@ -319,6 +435,16 @@ namespace BOOM{
     // likelihood of the current set of model parameters.
     virtual double impute_latent_data(RNG &rng);
 
+    // Impute latent data for different data series in parallel,
+    // using 'n' threads.  Each thread works with a copy of the model
+    // (its own filter and its own clones of the component processes
+    // and mixture components).  The sufficient statistics from the
+    // copies are combined with the main model after each sweep.  Call
+    // this after make_hmm_states().  Setting n <= 1 turns threading
+    // off.
+    void set_nthreads(int n);
+    int nthreads()const;
+
     // Returns the log likelihood value that was computed during the
     // most recent data imputation.
     double last_loglike()const{
@@ -358,8 +484,8 @@ namespace BOOM{
     // Details:
     //   On exit, pi0_ contains the marginal distribution of the final
     //   HmmState corresponding to the last event in process, and
-    //   filter_[t] contains the joint distribution of HMM states t-1
-    //   (rows) and t (columns).
+    //   filter_[t][k] is the probability that the transition from
+    //   HMM state t-1 to state t was transition k in transitions_.
     double filter(const PointProcess &process, const SourceVector &source);
 
     // Updates the state of the filter at time t to give the conditional
@@ -373,6 +499,29 @@ namespace BOOM{
     //   log p(events[t] | events[0, ..., t-1])
     double fwd_1(int t, const ProcessInfo &process_info);
 
+    // Scoring a process with fixed parameters.  The process need not
+    // be part of the training data, and no events are attributed to
+    // the component processes.  Both functions describe n+1 HMM
+    // states for a process with n events: element 0 is the state at
+    // the start of the observation window, and element t+1 is the
+    // state just after event t.
+    //
+    // Args:
+    //   process:  The point process to be scored.
+    //   source:  As in filter().
+    //
+    // most_likely_states returns the Viterbi path through the HMM
+    // state space.  States are indexed as in hmm_states().
+    std::vector<int> most_likely_states(
+        const PointProcess &process,
+        const SourceVector &source = SourceVector());
+
+    // Returns a matrix with n+1 rows and hmm_state_space_size()
+    // columns.  Row t is the marginal posterior distribution of the
+    // HMM state at time t.
+    Matrix state_probabilities(const PointProcess &process,
+                               const SourceVector &source = SourceVector());
+
     // Simulates the hidden Markov chain corresponding to 'process',
     // assuming it has just been filtered.
     // Args:
@@ -549,14 +698,36 @@ namespace BOOM{
     // component_processes_.
     int process_id(const PoissonProcess *process)const;
     double initialize_filter(const PointProcess &process);
+    // Sets log_joint[k] to log_prior[from] + log p(events[t],
+    // transition k | state[t-1] = from), where 'from' is the origin
+    // of transition k.
+    void fill_log_joint(int t,
+                        const ProcessInfo &process_info,
+                        const Vector &log_prior,
+                        Vector &log_joint)const;
     void create_process_info();
+    double impute_latent_data_with_threads(RNG &rng);
+
+    // The index of a transition into current_state, drawn from its
+    // conditional distribution given the filter at time t.
+    int draw_incoming_transition(RNG &rng, int t, int current_state);
+
+    // Draws the process responsible for the event at time t, given
+    // that it produced transition k.
+    PoissonProcess * sample_culprit(RNG &rng,
+                                    int k,
+                                    const ProcessInfo &process_info,
+                                    int t);
 
     // Storage needed for forward_backward filtering.  It is managed
     // during the call to initialize_filter, so it does not need
     // special attention in the constructor.
     Vector pi0_;
-    Vector one_;
-    std::vector<Matrix> filter_;
+    std::vector<Vector> filter_;
+
+    // The legal transitions among hmm_states_, built by
+    // make_hmm_states().
+    TransitionGraph transitions_;
     double last_loglike_;
     mutable Vector mutable_workspace_;
 
@@ -579,6 +750,9 @@ namespace BOOM{
     // to add_supervised_data().
     typedef boost::unordered_map<const PointProcess *, SourceVector> SourceMap;
     SourceMap known_source_store_;
+
+    // Copies of this model used for multi-threaded data imputation.
+    std::vector<Ptr<MarkovModulatedPoissonProcess> > workers_;
   };
 
 }
@@ -0,0 +1,112 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_PACKED_POINT_PROCESS_HPP_
+#define BOOM_PACKED_POINT_PROCESS_HPP_
+
+#include <vector>
+#include <Models/PointProcess/PointProcess.hpp>
+#include <cpputil/Date.hpp>
+#include <cpputil/DateTime.hpp>
+
+namespace BOOM{
+
+  // A compact, column oriented copy of a PointProcess, for models
+  // that make many passes over long event histories.  Each event in a
+  // PointProcess is a Data object holding a DateTime and a Ptr<Data>
+  // mark, and models with calendar dependent sufficient statistics
+  // have to recompute the day and hour of each event on every pass.
+  //
+  // A PackedPointProcess stores the event times as a sorted array of
+  // doubles, measured in days since midnight Jan 1 1970 (the same
+  // units used by DateTime arithmetic).  The hour of the week of each
+  // event is computed once, when the object is built, and stored in a
+  // single byte.  Marks live in a separate column, which is empty if
+  // no event has a mark.  Unmarked events take 9 bytes each.
+  class PackedPointProcess {
+   public:
+    PackedPointProcess();
+    explicit PackedPointProcess(const PointProcess &process);
+
+    int number_of_events()const{return times_.size();}
+
+    // The observation window is kept as DateTime objects, so that
+    // exposure computations agree exactly with those based on the
+    // original PointProcess.
+    const DateTime &window_begin()const{return begin_;}
+    const DateTime &window_end()const{return end_;}
+    double window_duration()const{return end_ - begin_;}
+
+    // The time of event i, in days since midnight Jan 1 1970.
+    double event_time(int i)const{return times_[i];}
+    const std::vector<double> &event_times()const{return times_;}
+
+    // Returns the time of event i as a DateTime.  The conversion
+    // from days since 1970 may differ from the original timestamp by
+    // a rounding error of about a microsecond.
+    DateTime timestamp(int i)const;
+
+    // Calendar features of event i, cached at construction.  The hour
+    // of the week is 24 * day_of_week + hour, so hour 0 is the first
+    // hour of Sunday.
+    int hour_of_week(int i)const{return hour_of_week_[i];}
+    DayNames day_of_week(int i)const{
+      return DayNames(hour_of_week_[i] / 24);}
+    int hour(int i)const{return hour_of_week_[i] % 24;}
+    const std::vector<unsigned char> &hours_of_week()const{
+      return hour_of_week_;}
+
+    // Calendar features of the start of the observation window.
+    // window_begin_time_to_next_hour() is measured in days, and
+    // matches window_begin().time_to_next_hour().
+    int window_begin_hour_of_week()const{return begin_hour_of_week_;}
+    double window_begin_time_to_next_hour()const{
+      return begin_time_to_next_hour_;}
+
+    // Returns true if any event has a mark.
+    bool has_marks()const{return !marks_.empty();}
+
+    // Returns the mark for event i, or NULL if event i is unmarked.
+    const Data * mark(int i)const;
+    Ptr<Data> mark_ptr(int i)const;
+
+    // Rebuild a PointProcess from the packed representation.  Event
+    // times are subject to the rounding described in timestamp().
+    PointProcess unpack()const;
+
+   private:
+    DateTime begin_;
+    DateTime end_;
+    unsigned char begin_hour_of_week_;
+    double begin_time_to_next_hour_;
+
+    std::vector<double> times_;
+    std::vector<unsigned char> hour_of_week_;
+    std::vector<Ptr<Data> > marks_;
+  };
+
+  // Returns the hour of the week (0..167) containing 'time', counting
+  // from midnight at the start of Sunday.
+  int hour_of_week(const DateTime &time);
+
+  // Returns the time of 'time' in days since midnight Jan 1 1970.
+  double days_since_epoch(const DateTime &time);
+
+}  // namespace BOOM
+
+#endif  // BOOM_PACKED_POINT_PROCESS_HPP_
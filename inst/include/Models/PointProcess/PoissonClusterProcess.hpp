@@ -74,6 +74,15 @@ namespace BOOM{
     virtual void clear_client_data();
     void impute_latent_data(RNG &rng);
 
+    // Impute latent data for different data series in parallel,
+    // using 'n' threads.  Each thread works with a clone of the model
+    // (its own filter and its own component processes and mark
+    // models), and the sufficient statistics from the clones are
+    // combined with this model after each sweep.  Setting n <= 1
+    // turns threading off.
+    void set_nthreads(int n);
+    int nthreads()const;
+
     // Sample the posterior distributions of the client models.  To be
     // called after impute_latent_data().
     virtual void sample_client_posterior();
@@ -293,6 +302,11 @@ namespace BOOM{
 
    private:
     void initialize();
+    void impute_latent_data_with_threads(RNG &rng);
+
+    // Add the sufficient statistics from the component processes and
+    // mark models in 'worker' to the corresponding models in *this.
+    void combine_client_data(const PoissonClusterProcess &worker);
     void fill_state_maps();  // make virtual
     void setup_filter();
     virtual void register_models_with_param_policy();
@@ -410,6 +424,9 @@ namespace BOOM{
     typedef std::map<Ptr<PointProcess>, std::vector<int> > SourceMap;
     SourceMap known_source_store_;
 
+    // Clones of this model used for multi-threaded data imputation.
+    std::vector<Ptr<PoissonClusterProcess> > workers_;
+
   };
 
 }
@@ -21,6 +21,7 @@
 #include <Models/ModelTypes.hpp>
 #include <cpputil/DateTime.hpp>
 #include <Models/PointProcess/PointProcess.hpp>
+#include <Models/PointProcess/PackedPointProcess.hpp>
 
 namespace BOOM{
 
@@ -47,6 +48,13 @@ namespace BOOM{
                                      const DateTime &t1) = 0;
     virtual void add_event(const DateTime &t) = 0;
 
+    // Add the events and the observation window from a packed point
+    // process.  The default implementation converts each event time
+    // back to a DateTime and calls add_event().  Subclasses whose
+    // sufficient statistics depend on calendar features should
+    // override it to use the features cached in 'data'.
+    virtual void add_data_raw(const PackedPointProcess &data);
+
     // Simulate a PointProcess between t0 and t1.  If a function-like
     // object that returns a Data * is passed as the third object then
     // the process will include marks for those events where the
@@ -37,6 +37,15 @@ namespace BOOM{
     void add_exposure_window(const DateTime &t0, const DateTime &t1);
     void add_event(const DateTime &t);
 
+    // Update using the calendar features cached in a packed point
+    // process, rather than recomputing them from each DateTime.
+    void Update(const PackedPointProcess &data);
+
+    // Args:
+    //   hour_of_week:  24 * day_of_week + hour for the event, as
+    //     returned by BOOM::hour_of_week().
+    void add_event(int hour_of_week);
+
     WeeklyCyclePoissonSuf * combine(Ptr<WeeklyCyclePoissonSuf>);
     WeeklyCyclePoissonSuf * combine(const WeeklyCyclePoissonSuf &);
     WeeklyCyclePoissonSuf * abstract_combine(Sufstat *s) override;
@@ -58,6 +67,14 @@ namespace BOOM{
     const Matrix &exposure()const;
     const Matrix &count()const;
    private:
+    // Increment exposure_ by 'duration' days, starting at the given
+    // hour of the week.  The first hour is only partially exposed:
+    // time_to_next_hour is the time (in days) between the start of
+    // the window and the end of its first hour.
+    void increment_exposure(int hour_of_week,
+                            double time_to_next_hour,
+                            double duration);
+
     // Keeps track of the number of events that take place during each
     // hour of the week.  Indexed by (day, hour).
     Matrix count_;
@@ -138,6 +155,7 @@ namespace BOOM{
     const Ptr<VectorParams> weekend_hour_of_day_cycle_prm()const;
 
     void add_data_raw(const PointProcess &);
+    void add_data_raw(const PackedPointProcess &data) override;
     void add_exposure_window(const DateTime &t0, const DateTime &t1) override;
     void add_event(const DateTime &t) override;
    private:
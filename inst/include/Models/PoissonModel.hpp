@@ -103,6 +103,9 @@ namespace BOOM{
     virtual double pdf(Ptr<Data> x, bool logscale) const;
     double pdf(const Data * x, bool logscale) const override;
     double pdf(uint x, bool logscale) const;
+    void fill_logp(const std::vector<Ptr<Data> > &data,
+                   int start,
+                   VectorView ans)const override;
     double logp(int x) const override;
 
     // moments and summaries:
@@ -41,6 +41,13 @@ namespace BOOM{
     // Returns the number of sampling methods that have been set.
     int number_of_sampling_methods() const override;
 
+    // If true, each call to sample_posterior() runs inside a
+    // WorkspaceRegion, so the storage for Vector, Matrix and
+    // SpdMatrix temporaries is recycled across the draws of that
+    // iteration instead of going back to the heap.  The default is
+    // false.
+    void set_recycle_temporaries(bool tf) {recycle_temporaries_ = tf;}
+
    protected:
     PosteriorSampler * sampler(int i) override {
       return samplers_[i].get();
@@ -50,7 +57,10 @@ namespace BOOM{
     }
 
    private:
+    void draw_samplers();
+
     std::vector<Ptr<PosteriorSampler> > samplers_;
+    bool recycle_temporaries_ = false;
   };
 
 }  // namespace BOOM
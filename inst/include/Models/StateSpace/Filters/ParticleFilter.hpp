@@ -0,0 +1,347 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_STATE_SPACE_PARTICLE_FILTER_HPP_
+#define BOOM_STATE_SPACE_PARTICLE_FILTER_HPP_
+
+#include <string>
+#include <vector>
+
+#include <LinAlg/Vector.hpp>
+#include <LinAlg/Matrix.hpp>
+#include <LinAlg/SpdMatrix.hpp>
+#include <distributions/rng.hpp>
+#include <Models/StateSpace/StateSpaceNormalMixture.hpp>
+#include <Models/StateSpace/StateSpaceLogitModel.hpp>
+#include <Models/StateSpace/StateSpacePoissonModel.hpp>
+#include <Models/StateSpace/StateSpaceStudentRegressionModel.hpp>
+#include <Models/Glm/PosteriorSamplers/BinomialLogitDataImputer.hpp>
+#include <Models/Glm/PosteriorSamplers/PoissonDataImputer.hpp>
+#include <Models/Glm/PosteriorSamplers/TDataImputer.hpp>
+
+namespace BOOM {
+
+  // A sequential Monte Carlo (particle) filter for the state of a
+  // StateSpaceNormalMixture model, for tracking the state as new
+  // observations arrive one at a time.  The Kalman filter in
+  // StateSpaceModelBase is conditional on the latent data imputed by
+  // the posterior samplers, so updating it with a new observation
+  // means re-running MCMC over the whole series.  The particle
+  // filter does O(number_of_particles) work per observation.
+  //
+  // Model parameters (the state model parameters and the
+  // coefficients in the observation model) are held fixed at their
+  // values in the model when each observation is processed.  The
+  // usual way to start the filter is with draws of the final state
+  // from an MCMC run on the training data.
+  //
+  // Each observation is processed by
+  //   (1) propagating each particle through the state equation,
+  //   (2) weighting each particle by the observation density,
+  //   (3) resampling (systematic) if the effective sample size drops
+  //       below a threshold, and
+  //   (4) after resampling, moving each particle with a Gibbs step
+  //       that leaves the filtering distribution invariant.  This is
+  //       the "resample-move" step that restores the diversity lost
+  //       in resampling.
+  //
+  // The move in step (4) uses the same data augmentation as the
+  // posterior samplers.  Given the particle's state, the observation
+  // is expressed as a Gaussian latent value with a known variance,
+  // using the data imputer from the corresponding posterior sampler.
+  // Given the latent value, the state is drawn exactly from its
+  // conditional distribution given the previous state, which is
+  // Gaussian.
+  //
+  // Steps (1), (2) and (4) are independent across particles, and can
+  // be split across threads with set_number_of_threads().
+  class StateSpaceParticleFilter {
+   public:
+    // Args:
+    //   model: The model whose state is to be tracked.  The model
+    //     must outlive the filter.
+    //   number_of_particles: The number of particles to use.
+    //   seeding_rng: The random number generator used to seed the
+    //     generators owned by the filter.
+    StateSpaceParticleFilter(StateSpaceNormalMixture *model,
+                             int number_of_particles,
+                             RNG &seeding_rng = GlobalRng::rng);
+    virtual ~StateSpaceParticleFilter() {}
+
+    // Set the particles to draws of the state at time 'time' - 1,
+    // with equal weights.  The next observation will be treated as
+    // the observation at time 'time'.
+    //
+    // Args:
+    //   state_draws: Each row is a draw of the state vector.  If
+    //     there are fewer rows than particles the rows are recycled.
+    //   time: The time index of the next observation.  This is
+    //     usually the time_dimension() of the training data.
+    void initialize(const Matrix &state_draws, int time);
+
+    // Set the particles to draws from the model's initial state
+    // distribution, so that the first observation is time 0.
+    void initialize_from_prior();
+
+    // Advance the filter by one time period without an observation.
+    // The particles move through the state equation and the weights
+    // are unchanged.
+    void skip_observation();
+
+    // Set the number of threads used to process the particles.
+    // Values less than 1 are treated as 1.
+    void set_number_of_threads(int n);
+
+    // Resampling takes place when the effective sample size falls
+    // below fraction * number_of_particles().  Setting fraction to 1
+    // resamples after every observation.  Setting it to 0 turns off
+    // resampling (and hence the move step).
+    void set_resampling_threshold(double fraction);
+
+    // The number of Gibbs moves applied to each particle after
+    // resampling.  Zero turns off the move step.
+    void set_number_of_move_steps(int n);
+
+    int number_of_particles() const {return particles_.ncol();}
+    int number_of_threads() const {return rngs_.size();}
+
+    // The time index of the next observation.
+    int time() const {return time_;}
+
+    // Column i is particle i.  The particles are draws of the state
+    // at time time() - 1, with the weights given by weights().
+    const Matrix &particles() const {return particles_;}
+    ConstVectorView particle(int i) const {return particles_.col(i);}
+    const Vector &weights() const {return weights_;}
+
+    double effective_sample_size() const;
+
+    // The weighted mean and variance of the particles.
+    Vector filtered_state_mean() const;
+    SpdMatrix filtered_state_variance() const;
+
+    // The sum of the log predictive densities of the observations
+    // processed since the last initialization.
+    double log_likelihood() const {return log_likelihood_;}
+
+    // The number of times the particles have been resampled since
+    // the last initialization.
+    int number_of_resampling_events() const {
+      return number_of_resampling_events_;}
+
+   protected:
+    // Process one observation, which derived classes have stored
+    // before calling.
+    //
+    // Args:
+    //   regression_contribution: The contribution of the regression
+    //     part of the model to the linear predictor for the
+    //     observation.
+    //
+    // Returns:
+    //   The log of the one-step predictive density of the
+    //   observation.
+    double process_observation(double regression_contribution);
+
+    // The log density of the current observation given the linear
+    // predictor (state contribution + regression contribution).
+    virtual double log_observation_density(
+        double linear_predictor) const = 0;
+
+    // Expresses the current observation as a Gaussian latent value
+    // on the scale of the linear predictor, given the value of the
+    // linear predictor.  This may be called from several threads at
+    // once with different RNGs.
+    //
+    // Args:
+    //   rng:  The random number generator to use for the imputation.
+    //   linear_predictor: The linear predictor for the particle being
+    //     moved.
+    //   value: On output, the imputed latent value.
+    //   variance: On output, the variance of the imputed latent
+    //     value about the linear predictor.
+    virtual void impute_latent_observation(RNG &rng,
+                                           double linear_predictor,
+                                           double *value,
+                                           double *variance) = 0;
+
+    StateSpaceNormalMixture *model() {return model_;}
+    const StateSpaceNormalMixture *model() const {return model_;}
+
+   private:
+    class Worker;
+    enum Stage {PROPAGATE, MOVE};
+
+    // Store the state transition for the next time period, and the
+    // square root of its error variance.
+    void prepare_transition();
+
+    // Draw the state for the current time period for particles in
+    // [begin, end), and compute their observation log densities.
+    void propagate(int begin, int end, RNG &rng);
+
+    // Apply the move step to particles in [begin, end).
+    void move(int begin, int end, RNG &rng);
+
+    // Run 'stage' over all the particles, splitting the particles
+    // across threads if more than one thread is in use.
+    void process_particles(Stage stage);
+
+    // Systematic resampling of particles_ and predicted_mean_.
+    void resample();
+
+    // Reset weights and counters after the particles are set.
+    void reset();
+
+    StateSpaceNormalMixture *model_;
+
+    // Column i is particle i.
+    Matrix particles_;
+
+    // Column i is the mean of particle i's state given the particle's
+    // value in the previous time period.  Retained for the move step.
+    Matrix predicted_mean_;
+
+    Vector weights_;
+    Vector log_observation_density_;
+
+    // The time index of the next observation.
+    int time_;
+
+    // If true the particles must be moved through the state equation
+    // before the next observation.  False immediately after
+    // initialize_from_prior().
+    bool needs_propagation_;
+
+    // True while processing an observation.  False in
+    // skip_observation().
+    bool have_observation_;
+
+    // The state transition for the period being processed, its error
+    // variance, and a square root of the error variance.
+    const SparseKalmanMatrix *transition_;
+    SpdMatrix state_error_variance_;
+    Matrix state_error_root_;
+
+    // Quantities for the move step, shared by all particles.
+    SparseVector observation_vector_;
+    Vector variance_times_observation_vector_;
+    double observation_vector_variance_;
+    double regression_contribution_;
+
+    double resampling_threshold_;
+    int number_of_move_steps_;
+    double log_likelihood_;
+    int number_of_resampling_events_;
+
+    // One RNG per thread.  rngs_[0] is used by the calling thread.
+    std::vector<RNG> rngs_;
+  };
+
+  //======================================================================
+  class StateSpaceLogitParticleFilter : public StateSpaceParticleFilter {
+   public:
+    StateSpaceLogitParticleFilter(StateSpaceLogitModel *model,
+                                  int number_of_particles,
+                                  RNG &seeding_rng = GlobalRng::rng,
+                                  int clt_threshold = 10);
+
+    // Process the next observation.
+    // Args:
+    //   successes:  The number of successes.
+    //   trials:  The number of trials.
+    //   predictors:  The vector of predictors for the regression.
+    // Returns:
+    //   The log predictive density of the observation.
+    double update(double successes, double trials, const Vector &predictors);
+
+   private:
+    double log_observation_density(double linear_predictor) const override;
+    void impute_latent_observation(RNG &rng,
+                                   double linear_predictor,
+                                   double *value,
+                                   double *variance) override;
+
+    StateSpaceLogitModel *model_;
+    BinomialLogitCltDataImputer data_imputer_;
+    double successes_;
+    double trials_;
+    double log_binomial_coefficient_;
+  };
+
+  //======================================================================
+  class StateSpacePoissonParticleFilter : public StateSpaceParticleFilter {
+   public:
+    StateSpacePoissonParticleFilter(StateSpacePoissonModel *model,
+                                    int number_of_particles,
+                                    RNG &seeding_rng = GlobalRng::rng);
+
+    // Process the next observation.
+    // Args:
+    //   count:  The number of events observed.
+    //   exposure:  The exposure associated with 'count'.
+    //   predictors:  The vector of predictors for the regression.
+    // Returns:
+    //   The log predictive density of the observation.
+    double update(double count, double exposure, const Vector &predictors);
+
+   private:
+    double log_observation_density(double linear_predictor) const override;
+    void impute_latent_observation(RNG &rng,
+                                   double linear_predictor,
+                                   double *value,
+                                   double *variance) override;
+
+    StateSpacePoissonModel *model_;
+    PoissonDataImputer data_imputer_;
+    double count_;
+    double exposure_;
+  };
+
+  //======================================================================
+  class StateSpaceStudentParticleFilter : public StateSpaceParticleFilter {
+   public:
+    StateSpaceStudentParticleFilter(StateSpaceStudentRegressionModel *model,
+                                    int number_of_particles,
+                                    RNG &seeding_rng = GlobalRng::rng);
+
+    // Process the next observation.
+    // Args:
+    //   y:  The observed value.
+    //   predictors:  The vector of predictors for the regression.
+    // Returns:
+    //   The log predictive density of the observation.
+    double update(double y, const Vector &predictors);
+
+   private:
+    double log_observation_density(double linear_predictor) const override;
+    void impute_latent_observation(RNG &rng,
+                                   double linear_predictor,
+                                   double *value,
+                                   double *variance) override;
+
+    StateSpaceStudentRegressionModel *model_;
+    TDataImputer data_imputer_;
+    double y_;
+    double sigma_;
+    double nu_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_STATE_SPACE_PARTICLE_FILTER_HPP_
@@ -25,6 +25,7 @@
 #include <LinAlg/Vector.hpp>
 #include <LinAlg/Matrix.hpp>
 #include <LinAlg/SpdMatrix.hpp>
+#include <LinAlg/FixedMatrix.hpp>
 #include <LinAlg/SubMatrix.hpp>
 #include <LinAlg/Types.hpp>
 
@@ -113,11 +114,13 @@ namespace BOOM{
     DenseMatrix * clone() const override {return new DenseMatrix(*this);}
     int nrow() const override {return m_.nrow();}
     int ncol() const override {return m_.ncol();}
+    // Small blocks use the unrolled kernels in FixedMatrix.hpp.
     void multiply(VectorView lhs, const ConstVectorView &rhs) const override {
-      lhs = m_ * rhs; }
+      small_matrix_multiply(m_, lhs, rhs); }
     void Tmult(VectorView lhs, const ConstVectorView &rhs) const override {
-      lhs = m_.Tmult(rhs); }
-    void multiply_inplace(VectorView x) const override { x = m_ * x;}
+      small_matrix_Tmult(m_, lhs, rhs); }
+    void multiply_inplace(VectorView x) const override {
+      small_matrix_multiply(m_, x, x);}
     void add_to(SubMatrix block) const override { block += m_; }
     Matrix dense() const override { return m_; }
    private:
@@ -79,6 +79,13 @@ namespace BOOM {
 
     void set_sigsq(double sigsq) override;
    private:
+    // Returns the position of day t inside the holiday's window of
+    // influence, or -1 if the holiday is not active on day t.
+    int window_position(int t)const;
+
+    // Extend window_position_ so that it covers day t.
+    void extend_window_positions(int t)const;
+
     // TODO(stevescott): Make this a unique_ptr once available.
     boost::shared_ptr<Holiday> holiday_;
     Date time_zero_;
@@ -87,6 +94,12 @@ namespace BOOM {
     Ptr<IdentityMatrix> identity_transition_matrix_;
     Ptr<ZeroMatrix> zero_state_variance_matrix_;
     std::vector<Ptr<SingleSparseDiagonalElementMatrix> > active_state_variance_matrix_;
+
+    // window_position_[t] caches window_position(t) for t >= 0, so
+    // that the per-time-point methods are a table lookup rather than
+    // a sequence of calendar computations.  The table grows as
+    // needed, and is cleared when time_zero_ changes.
+    mutable std::vector<int> window_position_;
   };
 
 }  // namespace BOOM
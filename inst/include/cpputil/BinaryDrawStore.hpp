@@ -0,0 +1,254 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_BINARY_DRAW_STORE_HPP_
+#define BOOM_BINARY_DRAW_STORE_HPP_
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <LinAlg/Vector.hpp>
+#include <LinAlg/VectorView.hpp>
+#include <LinAlg/Matrix.hpp>
+#include <Models/ParamTypes.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace BOOM {
+
+  // A binary, chunked, column-oriented store for MCMC draws.  It is
+  // an alternative to the text files written by ParamFileIoManager
+  // (which are slow to write and slow to parse) and to the R lists
+  // maintained by RListIoManager (which must hold all 'niter' draws
+  // in memory from the start of the run).
+  //
+  // A store contains a fixed set of named "columns," each holding a
+  // fixed-dimension vector per MCMC iteration.  Draws are buffered in
+  // memory and written one chunk of iterations at a time.  Within a
+  // chunk, each column's draws are contiguous, so a single parameter
+  // can be extracted without touching the others.
+  //
+  // File layout:
+  //   header:
+  //     8 bytes   magic string "BOOMDRAW"
+  //     uint32    byte order mark 0x01020304, in the writer's byte order
+  //     uint32    format version (currently 1)
+  //     uint32    number of columns
+  //     per column:
+  //       uint32  length of the column name
+  //       bytes   the column name
+  //       uint32  dimension (number of values per draw)
+  //       uint32  storage type (see StorageType below)
+  //   chunks (repeated until the end of the file):
+  //     uint32    number of iterations in the chunk (niter)
+  //     per column:
+  //       niter * dimension values of the column's storage type,
+  //       iteration-major (the draws for one iteration are contiguous).
+  //
+  // The byte offset of each column within a chunk is determined by
+  // the header, so readers can seek directly to the data they need.
+  // A file whose writer was interrupted mid-chunk can still be read:
+  // the trailing partial chunk is ignored.
+  namespace BinaryDrawStore {
+    enum StorageType {
+      // Values are stored exactly, as 8-byte doubles.
+      DOUBLE_STORAGE = 0,
+      // Values are rounded to 4-byte floats.  This halves the size of
+      // the file at the cost of about 7 significant digits of
+      // precision, which is usually far more than the Monte Carlo
+      // error in the draws.
+      FLOAT_STORAGE = 1
+    };
+
+    struct ColumnInfo {
+      std::string name;
+      int dim;
+      StorageType storage;
+      // Number of bytes occupied by a single draw of this column.
+      std::size_t bytes_per_draw() const;
+    };
+
+    //======================================================================
+    // A read-only view of the contents of a file.  On POSIX systems
+    // the file is memory-mapped, so pages are only read from disk when
+    // they are touched.  Elsewhere the file is read into memory.
+    class MappedFile {
+     public:
+      explicit MappedFile(const std::string &filename);
+      ~MappedFile();
+      const char *data() const {return data_;}
+      std::size_t size() const {return size_;}
+     private:
+      MappedFile(const MappedFile &rhs);
+      void operator=(const MappedFile &rhs);
+      const char *data_;
+      std::size_t size_;
+      bool mapped_;
+      std::vector<char> buffer_;
+    };
+
+    //======================================================================
+    // Appends MCMC draws to a file.  The columns are fixed when the
+    // file is created, and the header describing them is written
+    // immediately, so a file that has not yet received any draws can
+    // still be opened by a Reader.
+    class Writer {
+     public:
+      // Args:
+      //   filename:  The name of the file to write.  Any existing
+      //     contents are discarded.
+      //   columns: The columns to be stored.  Draws for column i are
+      //     written with set(i, draw).
+      //   chunk_size_in_iterations: The number of iterations to
+      //     buffer in memory before writing to disk.
+      Writer(const std::string &filename,
+             const std::vector<ColumnInfo> &columns,
+             int chunk_size_in_iterations = 100);
+
+      // The destructor writes any buffered draws.
+      ~Writer();
+
+      // Sets the value of the given column for the current iteration.
+      // Columns that are not set in an iteration are written as zeros.
+      void set(int column, const ConstVectorView &draw);
+
+      // Completes the current iteration.  If the chunk is full it is
+      // written to disk.
+      void end_iteration();
+
+      // Writes any buffered iterations to disk.
+      void flush();
+
+      int number_of_columns() const {return columns_.size();}
+      int number_of_draws() const {return number_of_draws_;}
+
+     private:
+      void write_header();
+
+      std::ofstream output_;
+      std::vector<ColumnInfo> columns_;
+      int chunk_size_;
+      int number_of_draws_;
+
+      // The number of completed iterations in the current chunk.
+      int iterations_in_chunk_;
+      // One buffer per column, holding chunk_size_ draws.
+      std::vector<Vector> chunk_buffers_;
+    };
+
+    //======================================================================
+    // Reads a file produced by a Writer.  Data are decoded lazily: an
+    // individual draw of an individual column can be read without
+    // touching the rest of the file.
+    class Reader {
+     public:
+      explicit Reader(const std::string &filename);
+
+      int number_of_draws() const {return number_of_draws_;}
+      int number_of_columns() const {return columns_.size();}
+      const ColumnInfo &column(int i) const {return columns_[i];}
+
+      // Returns the index of the column with the given name, or -1 if
+      // there is no such column.
+      int column_index(const std::string &name) const;
+
+      // Copies the requested draw of the given column into 'out',
+      // which must have the column's dimension.
+      void read(int iteration, int column, VectorView out) const;
+      Vector draw(int iteration, int column) const;
+
+      // Returns all the draws of a single column, one iteration per
+      // row.
+      Matrix column_draws(int column) const;
+
+     private:
+      const char *column_data(int iteration, int column) const;
+
+      boost::shared_ptr<MappedFile> file_;
+      std::vector<ColumnInfo> columns_;
+      // The byte offset of the start of each chunk's data (after its
+      // iteration count), the index of its first iteration, and the
+      // number of iterations it contains.
+      std::vector<std::size_t> chunk_offsets_;
+      std::vector<int> chunk_start_;
+      std::vector<int> chunk_size_;
+      int number_of_draws_;
+    };
+  }  // namespace BinaryDrawStore
+
+  //======================================================================
+  // Manages a collection of Params objects whose draws are recorded in
+  // a BinaryDrawStore.  The interface mirrors ParamFileIoManager and
+  // RListIoManager: call write() once per MCMC iteration while
+  // sampling, and stream() (after prepare_to_stream) to load the
+  // recorded draws back into the parameters one iteration at a time.
+  class BinaryParamIoManager {
+   public:
+    BinaryParamIoManager();
+
+    // Adds a parameter to the set being managed.  Parameters are
+    // recorded using their full (non-minimal) vectorization.
+    void add_parameter(Ptr<Params> parameter,
+                       const std::string &name,
+                       BinaryDrawStore::StorageType storage =
+                       BinaryDrawStore::DOUBLE_STORAGE);
+
+    // Opens 'filename' for writing.  Must be called after all
+    // parameters have been added.
+    void prepare_to_write(const std::string &filename,
+                          int chunk_size_in_iterations = 100);
+
+    // Records the current value of each managed parameter.
+    void write();
+
+    // Writes any buffered draws to the file.
+    void flush();
+
+    // Opens 'filename' for streaming, and positions the stream at the
+    // first recorded draw.
+    void prepare_to_stream(const std::string &filename);
+
+    // Sets each managed parameter to its value at the current stream
+    // position, then advances the position.
+    void stream();
+
+    // Moves the stream position forward n iterations.  This is useful
+    // for discarding burn-in.
+    void advance(int n);
+
+    // Moves the stream position back to the first draw.
+    void rewind();
+
+    int number_of_draws() const;
+
+   private:
+    std::vector<Ptr<Params> > parameters_;
+    std::vector<std::string> names_;
+    std::vector<BinaryDrawStore::StorageType> storage_;
+    boost::shared_ptr<BinaryDrawStore::Writer> writer_;
+    boost::shared_ptr<BinaryDrawStore::Reader> reader_;
+    // The column in reader_ corresponding to each parameter.
+    std::vector<int> reader_columns_;
+    int position_;
+    Vector workspace_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_BINARY_DRAW_STORE_HPP_
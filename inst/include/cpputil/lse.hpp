@@ -25,6 +25,28 @@ namespace BOOM{
   double lse_safe(const Vector &v);
   double lse_fast(const Vector &v);
 
+  // Kernels for the exponentials in log-sum-exp calculations.  They
+  // use an inline exp() with a maximum error of 2 ulp, written
+  // without branches or library calls so the compiler can vectorize
+  // the loops.  Results that would be subnormal are flushed to zero.
+
+  // Sets y[i] = exp(x[i] - shift) for i in [0, n), and returns the sum
+  // of the y's.  x and y may be the same array.
+  double exp_shifted(const double *x, double shift, double *y, int n);
+
+  // Returns the sum of exp(x[i] - shift) for i in [0, n).
+  double sum_exp_shifted(const double *x, double shift, int n);
+
+  // Row-wise versions, for a Matrix with one row of log probabilities
+  // (up to an additive constant) per observation.  The work is done
+  // a column at a time, so the inner loops run over contiguous
+  // memory.
+  //
+  // Returns a vector whose i'th element is lse(logprob.row(i)).
+  Vector lse_rows(const Matrix &logprob);
+  // Replaces each row with exp(row - lse(row)).
+  void normalize_logprob_rows(Matrix &logprob);
+
   // The log of the sum of 2 exponentials.  log(exp(x) + exp(y))
   inline double lse2(double x, double y){
     // returns log( exp(x) + exp(y));
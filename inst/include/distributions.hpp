@@ -30,6 +30,7 @@ namespace BOOM {
   void set_seed(unsigned int I1, unsigned int I2);
   class VectorView;
   class ConstVectorView;
+  class Chol;
 
   class TnSampler {
     // Implements adaptive rejection sampling for drawing from the
@@ -181,6 +182,11 @@ namespace BOOM {
   Vector rmvn_ivar_mt(RNG & rng, const Vector &Mu,
                       const SpdMatrix &Sigma_Inverse);
   Vector rmvn_ivar_L_mt(RNG & rng, const Vector &Mu, const Matrix &Ivar_chol);
+  // Draws from N(Mu, A^{-1}), where Ivar_chol is the Cholesky
+  // decomposition of A.  Samplers that have already factored the
+  // posterior precision (e.g. to compute the posterior mean) should
+  // call this rather than rmvn_ivar_mt, which factors it again.
+  Vector rmvn_ivar_L_mt(RNG & rng, const Vector &Mu, const Chol &Ivar_chol);
   Vector rmvn_ivar_U_mt(RNG & rng, const Vector &Mu,
                         const Matrix &Ivar_chol_transpose);
   Vector rmvn_suf_mt(RNG & rng, const SpdMatrix & Ivar, const Vector & IvarMu);
@@ -278,6 +284,26 @@ namespace BOOM {
   uint rmulti_mt(RNG &rng, const VectorView &);
   uint rmulti_mt(RNG &rng, const ConstVectorView &);
 
+  // Draws from the discrete distribution with log probabilities
+  // logprob, which need only be specified up to an additive constant.
+  // This is the same as
+  //   logprob.normalize_logprob();
+  //   return rmulti_mt(rng, logprob);
+  // in a single pass, without the check for normalization.
+  //
+  // Args:
+  //   rng:  The random number generator.
+  //   logprob:  On input, the log probabilities (up to a constant).
+  //     On output, the normalized probabilities.
+  //   log_normalizing_constant: If non-NULL, *log_normalizing_constant
+  //     is set to lse(logprob) for the input values.  This is the
+  //     log likelihood contribution in mixture models.
+  //
+  // Returns:
+  //   The index of the drawn element.
+  uint rmulti_logprob_mt(RNG &rng, Vector &logprob,
+                         double *log_normalizing_constant = nullptr);
+
   int rmulti(int, int);
   int rmulti_mt(RNG &, int, int);
 
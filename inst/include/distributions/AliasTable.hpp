@@ -0,0 +1,73 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_ALIAS_TABLE_HPP_
+#define BOOM_ALIAS_TABLE_HPP_
+
+#include <distributions/rng.hpp>
+#include <LinAlg/VectorView.hpp>
+#include <uint.hpp>
+#include <vector>
+
+namespace BOOM{
+
+  // Walker's alias method for repeated draws from a fixed discrete
+  // distribution.  Building the table costs O(K) for K categories.
+  // After that, each draw costs O(1): one uniform deviate, one table
+  // lookup and one comparison.  rmulti_mt does a linear scan (and sums
+  // the probabilities) on every call, so an AliasTable pays for itself
+  // when the same distribution is used for many draws with more than
+  // a handful of categories.
+  //
+  // The table is built with Vose's algorithm, which is numerically
+  // stable when some probabilities are much smaller than others.
+  class AliasTable {
+   public:
+    // An empty table.  Call set_probabilities before drawing.
+    AliasTable();
+
+    // Args:
+    //   probabilities: The probability of each category, up to a
+    //     proportionality constant.  Elements must be non-negative and
+    //     finite, with a positive sum.
+    explicit AliasTable(const ConstVectorView &probabilities);
+
+    // Rebuild the table for a new distribution, reusing the storage.
+    void set_probabilities(const ConstVectorView &probabilities);
+
+    // The number of categories.
+    uint size() const {return cutoff_.size();}
+
+    // Returns a draw in [0, size()) with probability proportional to
+    // the probabilities used to build the table.
+    uint draw(RNG &rng) const;
+
+   private:
+    // Category i is drawn with probability cutoff_[i] when box i is
+    // selected, and alias_[i] is drawn otherwise.
+    std::vector<double> cutoff_;
+    std::vector<uint> alias_;
+
+    // Workspace for set_probabilities.
+    std::vector<uint> small_;
+    std::vector<uint> large_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_ALIAS_TABLE_HPP_
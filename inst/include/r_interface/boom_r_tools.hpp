@@ -30,6 +30,7 @@
 #include <Models/CategoricalData.hpp>
 
 #include <stats/DataTable.hpp>
+#include <boost/shared_ptr.hpp>
 
 //======================================================================
 // Note that the functions listed here throw exceptions.  Code that
@@ -194,6 +195,77 @@ namespace BOOM{
   //     STRINGSXP then the first element is returned.
   std::string ToString(SEXP r_string);
 
+  // RVectorView and RMatrixView give BOOM code direct access to the
+  // numeric memory owned by an R object, without copying it.  Unlike
+  // ToBoomVectorView and ToBoomMatrixView, they keep the R object
+  // safe from R's garbage collector for as long as the view (or any
+  // copy of it) exists, so the view can safely be held by a model or
+  // data object for the duration of a fit.
+  //
+  // The object is registered with R_PreserveObject rather than
+  // PROTECT, because PROTECT requires strict stack discipline which a
+  // view stored inside another object cannot guarantee.
+  //
+  // If the R object is not stored as doubles (e.g. it is an integer
+  // or logical vector) then it is coerced, which necessarily makes a
+  // copy.  The copy is preserved in the same way.
+  class RNumericMemory {
+   public:
+    explicit RNumericMemory(SEXP r_object);
+    const double *data() const {return data_;}
+    int length() const {return length_;}
+    // Returns true if the R object had to be coerced to double.
+    bool is_copy() const {return is_copy_;}
+
+   private:
+    // Releases the preserved object when the last view referring to
+    // it is destroyed.
+    class Preserver {
+     public:
+      explicit Preserver(SEXP r_object);
+      ~Preserver();
+     private:
+      SEXP r_object_;
+    };
+    boost::shared_ptr<Preserver> preserver_;
+    const double *data_;
+    int length_;
+    bool is_copy_;
+  };
+
+  class RVectorView : public RNumericMemory {
+   public:
+    // Throws an exception if r_vector is not numeric.
+    explicit RVectorView(SEXP r_vector);
+    ConstVectorView view() const {
+      return ConstVectorView(data(), length(), 1);
+    }
+    double operator[](int i) const {return data()[i];}
+    int size() const {return length();}
+  };
+
+  class RMatrixView : public RNumericMemory {
+   public:
+    // Throws an exception if r_matrix is not an R matrix.
+    explicit RMatrixView(SEXP r_matrix);
+    ConstSubMatrix view() const {
+      return ConstSubMatrix(data(), nrow_, ncol_);
+    }
+    // R matrices are stored in column major order, so rows are
+    // strided views.
+    ConstVectorView row(int i) const {
+      return ConstVectorView(data() + i, ncol_, nrow_);
+    }
+    ConstVectorView col(int j) const {
+      return ConstVectorView(data() + j * nrow_, nrow_, 1);
+    }
+    int nrow() const {return nrow_;}
+    int ncol() const {return ncol_;}
+   private:
+    int nrow_;
+    int ncol_;
+  };
+
   // A Factor object is intended to be intialized with an R factor.
   class Factor {
    public:
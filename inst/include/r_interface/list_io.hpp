@@ -12,6 +12,8 @@
 #include <Models/ParamTypes.hpp>
 #include <Models/SpdParams.hpp>
 #include <Models/Glm/GlmCoefs.hpp>
+#include <cpputil/BinaryDrawStore.hpp>
+#include <stats/StreamingSummary.hpp>
 
 #include <r_interface/boom_r_tools.hpp>
 
@@ -59,15 +61,30 @@ namespace BOOM{
   //   io_manager.stream();
   //   do_something_with_the_current_value();
   // }
+  //
+  // Output can be thinned by calling set_thinning(k) before
+  // prepare_to_write.  Then only every k'th call to write() is
+  // recorded, and the list holds ceil(niter / k) draws.  Streaming
+  // reads the thinned draws one at a time as usual.  List elements
+  // that summarize draws instead of storing them (see
+  // SummaryListElement below) see every iteration regardless of
+  // thinning.
 
   class RListIoManager {
    public:
+    RListIoManager();
+
     // The class takes over ownership of 'element', and deletes it
     // when *this goes out of scope.
     void add_list_element(RListIoElement *element);
 
+    // Record only every 'thin'th iteration.  Must be called before
+    // prepare_to_write.
+    void set_thinning(int thin);
+    int thinning() const {return thin_;}
+
     // Returns a list with the necessary names and storage for keeping
-    // track of 'niter' parameters worth of output.
+    // track of 'niter' parameters worth of output (after thinning).
     SEXP prepare_to_write(int niter);
 
     // Takes an existing list as an argument, and gets each component
@@ -88,8 +105,19 @@ namespace BOOM{
     void advance(int n);
    private:
     std::vector<boost::shared_ptr<RListIoElement> > elements_;
+    int thin_;
+    // The number of calls to write() since prepare_to_write().
+    int iteration_;
   };
 
+  // Returns the draws of a single column of a binary draw store (see
+  // cpputil/BinaryDrawStore.hpp) as an R matrix, with one row per
+  // MCMC iteration.  Only the requested column is read from the file,
+  // so large runs can be recorded to disk with a BinaryParamIoManager
+  // and brought into R one parameter at a time, as needed.
+  SEXP BinaryDrawsToRMatrix(const BinaryDrawStore::Reader &reader,
+                            const std::string &column_name);
+
   //======================================================================
   // An RListIoelement takes care of allocating space, recording to,
   // and streaming parameters from an R list.  One instance is
@@ -123,6 +151,14 @@ namespace BOOM{
     // Return the name of the component in the list.
     const std::string &name()const;
 
+    // Elements that store one entry per recorded draw return false.
+    // Elements that reduce the sequence of draws to a fixed-size
+    // summary return true.  Summarizing elements are passed the total
+    // number of iterations in prepare_to_write, and have write()
+    // called every iteration even when the RListIoManager is thinning
+    // its output.
+    virtual bool summarizes_draws() const {return false;}
+
     // Move position in stream forward by n places.
     void advance(int n);
    protected:
@@ -458,6 +494,69 @@ namespace BOOM{
     ArrayView array_view_;
   };
 
+  //----------------------------------------------------------------------
+  // A SummaryListElement reduces the draws of a vector or matrix
+  // valued quantity to a summary, so that high dimensional output can
+  // be monitored without storing every draw.  The list component is
+  // itself a list with elements
+  //   mean: The posterior mean of each element.
+  //   variance: The posterior variance of each element.
+  //   quantiles: Estimated posterior quantiles (if any were
+  //     requested), with a trailing dimension indexing the
+  //     probabilities.
+  //   effective.sample.size: A batch-means estimate of the effective
+  //     number of independent draws for each element.
+  //   draws: The number of draws summarized.
+  // For matrix-valued quantities each summary has the dimensions of
+  // the matrix.
+  //
+  // The summaries are copied into the R list each time a batch of
+  // draws is completed, and after the final iteration.  Summary
+  // elements are not streamed.
+  class SummaryListElement : public RListIoElement {
+   public:
+    // Args:
+    //   callback: Supplies the vector to be summarized.  The
+    //     SummaryListElement takes ownership of the callback.
+    //   name:  The name of the component in the list.
+    //   quantile_probs: The probabilities of the quantiles to be
+    //     estimated.  If empty, no quantiles are reported.
+    //   batch_size: The batch size used to estimate the effective
+    //     sample size.
+    SummaryListElement(VectorIoCallback *callback,
+                       const std::string &name,
+                       const Vector &quantile_probs = Vector(),
+                       int batch_size = 50);
+
+    // Use this constructor to summarize a matrix-valued quantity.
+    SummaryListElement(MatrixIoCallback *callback,
+                       const std::string &name,
+                       const Vector &quantile_probs = Vector(),
+                       int batch_size = 50);
+
+    bool summarizes_draws() const override {return true;}
+    SEXP prepare_to_write(int niter) override;
+    void write() override;
+    // Summaries cannot be streamed, so this is a no-op.
+    void stream() override {}
+    void prepare_to_stream(SEXP object) override {}
+
+   private:
+    // Copy the current state of the summary into the R list.
+    void fill_buffer();
+    Vector current_draw() const;
+
+    boost::shared_ptr<VectorIoCallback> vector_callback_;
+    boost::shared_ptr<MatrixIoCallback> matrix_callback_;
+    std::vector<double> quantile_probs_;
+    int batch_size_;
+    boost::shared_ptr<StreamingSummary> summary_;
+    int niter_;
+    // Dimensions of each summarized draw.  One element for vectors,
+    // two for matrices.
+    std::vector<int> dims_;
+  };
+
   //----------------------------------------------------------------------
   // A NativeArrayListElement manages output for one or more
   // parameters where a single MCMC iteration is represented by an R
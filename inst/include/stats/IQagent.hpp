@@ -21,6 +21,9 @@
 // Implementation of the incremental quantile estimator from Chambers
 // et. al. in Stat Science 2006, pp 463-475.
 //
+// IQagent is only accurate near the probabilities in its grid.  See
+// QuantileSketch for an estimator that is accurate at any
+// probability and that can combine summaries of separate streams.
 
 #include <vector>
 #include <stats/ECDF.hpp>
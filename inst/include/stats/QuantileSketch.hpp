@@ -0,0 +1,97 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_QUANTILE_SKETCH_HPP_
+#define BOOM_QUANTILE_SKETCH_HPP_
+
+#include <vector>
+
+namespace BOOM {
+
+  // A mergeable streaming quantile estimator, based on the KLL sketch
+  // of Karnin, Lang, and Liberty (FOCS 2016).  It offers the same
+  // add/quantile/cdf interface as IQagent, but two sketches built
+  // from separate streams (e.g. different threads or MCMC chains) can
+  // be combined into a sketch of the pooled stream.  The cost of
+  // add() is amortized O(1), independent of the number of
+  // probabilities of interest, and quantile() works for any
+  // probability, not just a fixed grid.
+  //
+  // The sketch is a hierarchy of "compactors."  Level h holds values
+  // that each represent 2^h observations.  When a level fills up it
+  // is sorted and every other value is promoted to the next level.
+  // Lower levels get geometrically smaller capacities, so total
+  // storage is O(accuracy) values.  The rank error of a quantile
+  // estimate is roughly proportional to 1 / accuracy.
+  //
+  // Compaction alternates between keeping the odd and even positioned
+  // values, rather than choosing at random, so results are
+  // reproducible.
+  class QuantileSketch {
+   public:
+    // Args:
+    //   accuracy: The capacity of the largest compactor.  Larger
+    //     values give more accurate quantiles at the cost of more
+    //     memory.  The rank error is roughly 1.7 / accuracy.
+    explicit QuantileSketch(int accuracy = 200);
+
+    void add(double x);
+
+    // Merge the observations summarized by rhs into *this.
+    void combine(const QuantileSketch &rhs);
+
+    // Returns the estimated quantile corresponding to 'prob'.
+    double quantile(double prob) const;
+
+    // Returns the estimated fraction of observations <= x.
+    double cdf(double x) const;
+
+    // Sort the retained values into the table used by quantile() and
+    // cdf().  This happens automatically when needed, but calling it
+    // explicitly avoids the cost at the first query.
+    void update_cdf() const;
+
+    double number_of_observations() const {return nobs_;}
+    int accuracy() const {return accuracy_;}
+    void clear();
+
+   private:
+    void add_level();
+    void compress();
+    void compact(int level);
+
+    int accuracy_;
+    double nobs_;
+    double min_;
+    double max_;
+    std::vector<std::vector<double> > levels_;
+    // The parity of the next compaction at each level.
+    std::vector<bool> keep_odd_;
+    std::vector<int> capacities_;
+    int total_capacity_;
+    int retained_size_;
+
+    // Sorted (value, cumulative weight) table built by update_cdf().
+    mutable bool table_is_current_;
+    mutable std::vector<double> sorted_values_;
+    mutable std::vector<double> cumulative_weights_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_QUANTILE_SKETCH_HPP_
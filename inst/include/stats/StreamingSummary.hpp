@@ -0,0 +1,98 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_STREAMING_SUMMARY_HPP_
+#define BOOM_STREAMING_SUMMARY_HPP_
+
+#include <vector>
+#include <LinAlg/Vector.hpp>
+#include <LinAlg/VectorView.hpp>
+#include <LinAlg/Matrix.hpp>
+#include <stats/QuantileSketch.hpp>
+
+namespace BOOM {
+
+  // Summarizes a stream of vector-valued MCMC draws without storing
+  // them.  Each coordinate of the draws is tracked separately.  The
+  // summary maintains
+  //   * the running mean and variance (using Welford's algorithm, which
+  //     is numerically stable for long runs),
+  //   * optional quantile estimates (using one QuantileSketch per
+  //     coordinate),
+  //   * a batch-means estimate of the effective sample size.
+  class StreamingSummary {
+   public:
+    // Args:
+    //   dim:  The dimension of each draw.
+    //   batch_size: The number of consecutive draws averaged into
+    //     each batch for the batch-means effective sample size.
+    //   quantile_probs: The probabilities of the quantiles to be
+    //     estimated.  If empty, no quantiles are tracked.
+    explicit StreamingSummary(
+        int dim,
+        int batch_size = 50,
+        const std::vector<double> &quantile_probs = std::vector<double>());
+
+    // Adds a draw to the summary.
+    void update(const ConstVectorView &draw);
+
+    int dim() const {return mean_.size();}
+    int number_of_draws() const {return number_of_draws_;}
+    const std::vector<double> &quantile_probs() const {
+      return quantile_probs_;
+    }
+
+    const Vector &mean() const {return mean_;}
+
+    // The sample variance (with divisor n - 1) of each coordinate.
+    Vector variance() const;
+
+    // Returns a dim() x quantile_probs().size() matrix of estimated
+    // quantiles.  Returns zeros if no draws have been seen.
+    Matrix quantiles() const;
+
+    // The effective sample size of each coordinate, estimated by
+    //
+    //   n * variance / (batch_size * variance of the batch means),
+    //
+    // using the completed batches.  If fewer than two batches have
+    // been completed, or a coordinate is constant, then the number of
+    // draws is returned for that coordinate.
+    Vector effective_sample_size() const;
+
+   private:
+    int number_of_draws_;
+    Vector mean_;
+    // Running sum of squared deviations from the mean.
+    Vector sum_of_squares_;
+
+    std::vector<double> quantile_probs_;
+    std::vector<QuantileSketch> quantile_sketches_;
+
+    int batch_size_;
+    int draws_in_current_batch_;
+    Vector current_batch_sum_;
+    int number_of_batches_;
+    // Welford accumulators for the batch means.
+    Vector batch_mean_mean_;
+    Vector batch_mean_sum_of_squares_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_STREAMING_SUMMARY_HPP_
@@ -0,0 +1,261 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <LinAlg/BatchedCholesky.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <sstream>
+
+#include <cpputil/report_error.hpp>
+#include <distributions.hpp>
+
+namespace BOOM{
+
+  namespace {
+    const int W = BatchedCholesky::batch_width;
+
+    // Each of the following kernels works on one block of W
+    // interleaved systems of dimension n.  Element (i, j) of the
+    // matrices in the block is the W-vector starting at
+    // matrix + (i + n * j) * W, and element i of the vectors is the
+    // W-vector starting at vector + i * W.  The innermost loops run
+    // over the W systems, and have a fixed trip count so the compiler
+    // can vectorize them.
+
+    // Compute the lower Cholesky factors L of the block of matrices
+    // in 'spd', using only their lower triangles.  The upper triangle
+    // of L is not written.  A system that is not positive definite
+    // has ok[l] set to 0, and its pivots replaced by 1 so that the
+    // arithmetic on the other systems in the block is unaffected.
+    //
+    // Sums are accumulated in local arrays, which the compiler knows
+    // cannot alias the inputs.
+    void cholesky_block(const double *spd, double *L, int n, char *ok) {
+      double value[W];
+      double inverse_root[W];
+      for (int l = 0; l < W; ++l) ok[l] = 1;
+      for (int j = 0; j < n; ++j) {
+        const double *Ajj = spd + (j + n * j) * W;
+        for (int l = 0; l < W; ++l) value[l] = Ajj[l];
+        for (int k = 0; k < j; ++k) {
+          const double *Ljk = L + (j + n * k) * W;
+          for (int l = 0; l < W; ++l) value[l] -= Ljk[l] * Ljk[l];
+        }
+        double *Ljj = L + (j + n * j) * W;
+        for (int l = 0; l < W; ++l) {
+          bool positive = value[l] > 0;
+          ok[l] &= positive;
+          Ljj[l] = std::sqrt(positive ? value[l] : 1.0);
+          inverse_root[l] = 1.0 / Ljj[l];
+        }
+        for (int i = j + 1; i < n; ++i) {
+          const double *Aij = spd + (i + n * j) * W;
+          for (int l = 0; l < W; ++l) value[l] = Aij[l];
+          for (int k = 0; k < j; ++k) {
+            const double *Lik = L + (i + n * k) * W;
+            const double *Ljk = L + (j + n * k) * W;
+            for (int l = 0; l < W; ++l) value[l] -= Lik[l] * Ljk[l];
+          }
+          double *Lij = L + (i + n * j) * W;
+          for (int l = 0; l < W; ++l) Lij[l] = value[l] * inverse_root[l];
+        }
+      }
+    }
+
+    // x = L^{-1} x.
+    void forward_solve_block(const double *L, double *x, int n) {
+      double value[W];
+      for (int i = 0; i < n; ++i) {
+        double *xi = x + i * W;
+        for (int l = 0; l < W; ++l) value[l] = xi[l];
+        for (int k = 0; k < i; ++k) {
+          const double *Lik = L + (i + n * k) * W;
+          const double *xk = x + k * W;
+          for (int l = 0; l < W; ++l) value[l] -= Lik[l] * xk[l];
+        }
+        const double *Lii = L + (i + n * i) * W;
+        for (int l = 0; l < W; ++l) xi[l] = value[l] / Lii[l];
+      }
+    }
+
+    // x = L^{-T} x.
+    void backward_solve_block(const double *L, double *x, int n) {
+      double value[W];
+      for (int i = n - 1; i >= 0; --i) {
+        double *xi = x + i * W;
+        for (int l = 0; l < W; ++l) value[l] = xi[l];
+        for (int k = i + 1; k < n; ++k) {
+          const double *Lki = L + (k + n * i) * W;
+          const double *xk = x + k * W;
+          for (int l = 0; l < W; ++l) value[l] -= Lki[l] * xk[l];
+        }
+        const double *Lii = L + (i + n * i) * W;
+        for (int l = 0; l < W; ++l) xi[l] = value[l] / Lii[l];
+      }
+    }
+  }  // namespace
+
+  BatchedCholesky::BatchedCholesky()
+      : dim_(0),
+        number_of_systems_(0),
+        number_of_threads_(1)
+  {}
+
+  BatchedCholesky::BatchedCholesky(int dim, int number_of_systems)
+      : dim_(0),
+        number_of_systems_(0),
+        number_of_threads_(1)
+  {
+    resize(dim, number_of_systems);
+  }
+
+  void BatchedCholesky::resize(int dim, int number_of_systems) {
+    if (dim < 0 || number_of_systems < 0) {
+      report_error("Negative size passed to BatchedCholesky::resize.");
+    }
+    dim_ = dim;
+    number_of_systems_ = number_of_systems;
+    int nblocks = number_of_blocks();
+    precision_.assign(nblocks * dim * dim * W, 0.0);
+    cholesky_.assign(precision_.size(), 0.0);
+    rhs_.assign(nblocks * dim * W, 0.0);
+    noise_.assign(rhs_.size(), 0.0);
+    solution_.assign(rhs_.size(), 0.0);
+    positive_definite_.assign(nblocks * W, 1);
+    // The padding systems at the end of the last block (and all the
+    // others, until they are set) are identity matrices, so they
+    // factor cleanly.
+    for (int b = 0; b < nblocks; ++b) {
+      for (int i = 0; i < dim; ++i) {
+        double *diagonal = &precision_[(b * dim * dim + i + dim * i) * W];
+        for (int l = 0; l < W; ++l) diagonal[l] = 1.0;
+      }
+    }
+  }
+
+  void BatchedCholesky::set_number_of_threads(int n) {
+    if (n < 1) {
+      report_error("BatchedCholesky needs at least one thread.");
+    }
+    number_of_threads_ = n;
+  }
+
+  void BatchedCholesky::set_system(
+      int g, const SpdMatrix &precision, const Vector &rhs) {
+    if (g < 0 || g >= number_of_systems_) {
+      report_error("System index out of range in BatchedCholesky.");
+    }
+    if (precision.nrow() != dim_ || rhs.size() != dim_) {
+      std::ostringstream err;
+      err << "BatchedCholesky has dimension " << dim_
+          << " but set_system was passed a " << precision.nrow()
+          << " x " << precision.ncol() << " matrix and a vector of size "
+          << rhs.size() << ".";
+      report_error(err.str());
+    }
+    int stride = dim_ * dim_;
+    for (int j = 0; j < dim_; ++j) {
+      for (int i = j; i < dim_; ++i) {
+        precision_[position(g, i + dim_ * j, stride)] = precision(i, j);
+      }
+    }
+    for (int i = 0; i < dim_; ++i) {
+      rhs_[position(g, i, dim_)] = rhs[i];
+    }
+  }
+
+  void BatchedCholesky::simulate_noise(int g, RNG &rng) {
+    if (g < 0 || g >= number_of_systems_) {
+      report_error("System index out of range in BatchedCholesky.");
+    }
+    for (int i = 0; i < dim_; ++i) {
+      noise_[position(g, i, dim_)] = rnorm_mt(rng);
+    }
+  }
+
+  void BatchedCholesky::solve() {
+    process(false);
+  }
+
+  void BatchedCholesky::draw() {
+    process(true);
+  }
+
+  Vector BatchedCholesky::solution(int g) const {
+    Vector ans(dim_);
+    for (int i = 0; i < dim_; ++i) {
+      ans[i] = solution_[position(g, i, dim_)];
+    }
+    return ans;
+  }
+
+  bool BatchedCholesky::all_positive_definite() const {
+    for (int g = 0; g < number_of_systems_; ++g) {
+      if (!positive_definite_[g]) return false;
+    }
+    return true;
+  }
+
+  bool BatchedCholesky::process_blocks(
+      int first_block, int end_block, bool add_noise) {
+    int matrix_stride = dim_ * dim_ * W;
+    int vector_stride = dim_ * W;
+    for (int b = first_block; b < end_block; ++b) {
+      double *L = cholesky_.data() + b * matrix_stride;
+      double *x = solution_.data() + b * vector_stride;
+      cholesky_block(precision_.data() + b * matrix_stride, L, dim_,
+                     positive_definite_.data() + b * W);
+      const double *rhs = rhs_.data() + b * vector_stride;
+      std::copy(rhs, rhs + vector_stride, x);
+      forward_solve_block(L, x, dim_);
+      if (add_noise) {
+        // L^{-T} (L^{-1} b + z) is the mean P^{-1} b plus the noise
+        // L^{-T} z, which has variance P^{-1}.
+        const double *z = noise_.data() + b * vector_stride;
+        for (int i = 0; i < vector_stride; ++i) x[i] += z[i];
+      }
+      backward_solve_block(L, x, dim_);
+    }
+    return true;
+  }
+
+  void BatchedCholesky::process(bool add_noise) {
+    int nblocks = number_of_blocks();
+    int nthreads = std::min(number_of_threads_, nblocks);
+#ifndef _WIN32
+    if (nthreads > 1) {
+      std::vector<std::future<bool> > results;
+      int chunk_size = (nblocks + nthreads - 1) / nthreads;
+      for (int begin = 0; begin < nblocks; begin += chunk_size) {
+        int end = std::min(begin + chunk_size, nblocks);
+        results.emplace_back(std::async(
+            std::launch::async, &BatchedCholesky::process_blocks,
+            this, begin, end, add_noise));
+      }
+      for (int i = 0; i < results.size(); ++i) {
+        results[i].get();
+      }
+      return;
+    }
+#endif
+    process_blocks(0, nblocks, add_noise);
+  }
+
+}  // namespace BOOM
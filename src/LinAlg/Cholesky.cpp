@@ -19,6 +19,7 @@
 #include <cpputil/report_error.hpp>
 #include <sstream>
 #include <LinAlg/Vector.hpp>
+#include <LinAlg/blas.hpp>
 
 extern "C"{
   /*  DPOTRF computes the Cholesky factorization of a real symmetric
@@ -40,19 +41,30 @@ extern "C"{
 }
 
 namespace BOOM{
+    Chol::Chol()
+      : pos_def(false)
+    {}
+
     Chol::Chol(const Matrix &m)
-      : dcmp(m),
-	pos_def(true)
+      : pos_def(true)
     {
+      decompose(m);
+    }
+
+    bool Chol::decompose(const Matrix &m){
       if(!m.is_square()){
 	pos_def=false;
 	dcmp = Matrix();
-      } else{
-	int info=0;
-	int n = m.nrow();
-	dpotrf_("L", &n, dcmp.data(), &n, &info);
-	if(info>0) pos_def=false;
+        return pos_def;
       }
+      // Copy assignment keeps the existing allocation when the
+      // dimensions agree.
+      dcmp = m;
+      int info=0;
+      int n = m.nrow();
+      dpotrf_("L", &n, dcmp.data(), &n, &info);
+      pos_def = (info == 0);
+      return pos_def;
     }
 
     SpdMatrix Chol::original_matrix()const{
@@ -128,6 +140,50 @@ namespace BOOM{
       return ans;
     }
 
+    void Chol::solve_inplace(Vector &b)const{
+      check();
+      int n = dcmp.nrow();
+      if(b.size() != n){
+        report_error("Wrong size argument in Chol::solve_inplace.");
+      }
+      int ncol_b = 1;
+      int info=0;
+      dpotrs_("L", &n, &ncol_b, dcmp.data(), &n, b.data(), &n, &info);
+      if(info<0){
+	report_error("Chol::solve_inplace problem with cholesky solver");
+      }
+    }
+
+    // The triangular operations read only the lower triangle of dcmp,
+    // so the original matrix left above the diagonal by dpotrf does
+    // not need to be zeroed.
+    void Chol::Lmult_inplace(Vector &x)const{
+      check();
+      if(x.size() != dcmp.nrow()){
+        report_error("Wrong size argument in Chol::Lmult_inplace.");
+      }
+      blas::dtrmv(blas::Lower, blas::NoTrans, blas::NonUnit, dcmp.nrow(),
+                  dcmp.data(), dcmp.nrow(), x.data(), 1);
+    }
+
+    void Chol::Lsolve_inplace(Vector &x)const{
+      check();
+      if(x.size() != dcmp.nrow()){
+        report_error("Wrong size argument in Chol::Lsolve_inplace.");
+      }
+      blas::dtrsv(blas::Lower, blas::NoTrans, blas::NonUnit, dcmp.nrow(),
+                  dcmp.data(), dcmp.nrow(), x.data(), 1);
+    }
+
+    void Chol::LTsolve_inplace(Vector &x)const{
+      check();
+      if(x.size() != dcmp.nrow()){
+        report_error("Wrong size argument in Chol::LTsolve_inplace.");
+      }
+      blas::dtrsv(blas::Lower, blas::Trans, blas::NonUnit, dcmp.nrow(),
+                  dcmp.data(), dcmp.nrow(), x.data(), 1);
+    }
+
     // returns the log of the determinant of A
     double Chol::logdet()const{
       ConstVectorView d(diag(dcmp));
@@ -0,0 +1,121 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <LinAlg/FixedMatrix.hpp>
+
+namespace BOOM{
+
+  namespace {
+    template <int N>
+    bool cholesky_impl(const double *spd, double *L) {
+      FixedMatrix<N, N> A;
+      A.copy_from(spd);
+      FixedMatrix<N, N> ans;
+      bool ok = fixed_cholesky(A, ans);
+      ans.copy_to(L);
+      return ok;
+    }
+
+    template <int NROW, int NCOL>
+    void multiply_impl(const double *A, VectorView y,
+                       const ConstVectorView &x, bool transpose) {
+      FixedMatrix<NROW, NCOL> m;
+      m.copy_from(A);
+      if (transpose) {
+        m.Tmult(y, x);
+      } else {
+        m.multiply(y, x);
+      }
+    }
+
+    template <int NROW>
+    void multiply_dispatch(int ncol, const double *A, VectorView y,
+                           const ConstVectorView &x, bool transpose) {
+      switch (ncol) {
+        case 1: multiply_impl<NROW, 1>(A, y, x, transpose); return;
+        case 2: multiply_impl<NROW, 2>(A, y, x, transpose); return;
+        case 3: multiply_impl<NROW, 3>(A, y, x, transpose); return;
+        case 4: multiply_impl<NROW, 4>(A, y, x, transpose); return;
+        default:
+          report_error("Column dimension out of range in fixed_multiply.");
+      }
+    }
+
+    void multiply_dispatch(int nrow, int ncol, const double *A, VectorView y,
+                           const ConstVectorView &x, bool transpose) {
+      switch (nrow) {
+        case 1: multiply_dispatch<1>(ncol, A, y, x, transpose); return;
+        case 2: multiply_dispatch<2>(ncol, A, y, x, transpose); return;
+        case 3: multiply_dispatch<3>(ncol, A, y, x, transpose); return;
+        case 4: multiply_dispatch<4>(ncol, A, y, x, transpose); return;
+        default:
+          report_error("Row dimension out of range in fixed_multiply.");
+      }
+    }
+
+    bool is_small(const Matrix &A) {
+      return A.nrow() <= max_fixed_matrix_dimension
+          && A.ncol() <= max_fixed_matrix_dimension
+          && A.nrow() > 0
+          && A.ncol() > 0;
+    }
+  }  // namespace
+
+  bool fixed_cholesky(int n, const double *spd, double *L) {
+    switch (n) {
+      case 1: return cholesky_impl<1>(spd, L);
+      case 2: return cholesky_impl<2>(spd, L);
+      case 3: return cholesky_impl<3>(spd, L);
+      case 4: return cholesky_impl<4>(spd, L);
+      default:
+        report_error("Dimension out of range in fixed_cholesky.");
+    }
+    return false;
+  }
+
+  void fixed_multiply(int nrow, int ncol, const double *A,
+                      VectorView y, const ConstVectorView &x) {
+    multiply_dispatch(nrow, ncol, A, y, x, false);
+  }
+
+  void fixed_Tmult(int nrow, int ncol, const double *A,
+                   VectorView y, const ConstVectorView &x) {
+    multiply_dispatch(nrow, ncol, A, y, x, true);
+  }
+
+  void small_matrix_multiply(const Matrix &A,
+                             VectorView y,
+                             const ConstVectorView &x) {
+    if (is_small(A)) {
+      fixed_multiply(A.nrow(), A.ncol(), A.data(), y, x);
+    } else {
+      y = A * x;
+    }
+  }
+
+  void small_matrix_Tmult(const Matrix &A,
+                          VectorView y,
+                          const ConstVectorView &x) {
+    if (is_small(A)) {
+      fixed_Tmult(A.nrow(), A.ncol(), A.data(), y, x);
+    } else {
+      y = A.Tmult(x);
+    }
+  }
+
+}  // namespace BOOM
@@ -16,28 +16,204 @@
   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
 */
 #include <LinAlg/Kronecker.hpp>
+#include <LinAlg/Cholesky.hpp>
+#include <LinAlg/blas.hpp>
+#include <distributions.hpp>
+#include <cpputil/report_error.hpp>
+#include <algorithm>
 
 namespace BOOM{
   Matrix Kronecker(const Matrix &A, const Matrix &B){
     uint nra = A.nrow();
     uint nca = A.ncol();
+    uint nrb = B.nrow();
+    uint ncb = B.ncol();
+    Matrix ans(nra * nrb, nca * ncb);
+    for(uint ja = 0; ja < nca; ++ja){
+      for(uint jb = 0; jb < ncb; ++jb){
+        double *column = ans.data() + (ja * ncb + jb) * ans.nrow();
+        const double *b = B.data() + jb * nrb;
+        for(uint ia = 0; ia < nra; ++ia){
+          double a = A(ia, ja);
+          for(uint ib = 0; ib < nrb; ++ib) column[ia * nrb + ib] = a * b[ib];
+        }
+      }
+    }
+    return ans;
+  }
 
-    Matrix tmp = A(0,0)*B;
-    Matrix ans(tmp);
-    for(uint j=1; j<nca; ++j){
-      tmp = A(0,j)*B;
-      ans = cbind(ans,tmp);
+  namespace {
+    // X = L X or X = L^T X (Left), or X = X L or X = X L^T (Right),
+    // for lower triangular L.
+    void triangular_multiply(blas::SIDE side, blas::TRANSPOSE trans,
+                             const Matrix &L, Matrix &X){
+      blas::dtrmm(side, blas::Lower, trans, blas::NonUnit,
+                  X.nrow(), X.ncol(), 1.0, L.data(), L.nrow(),
+                  X.data(), X.nrow());
     }
 
-    for(uint i=1; i<nra; ++i){
-      tmp = A(i,0)*B;
-      Matrix row(tmp);
-      for(uint j = 1; j<nca; ++j){
-        tmp = A(i,j)*B;
-        row = cbind(row, tmp);
-      }
-      ans = rbind(ans,row);
+    // X = L^{-1} X, L^{-T} X, X L^{-1} or X L^{-T}.
+    void triangular_solve(blas::SIDE side, blas::TRANSPOSE trans,
+                          const Matrix &L, Matrix &X){
+      blas::dtrsm(side, blas::Lower, trans, blas::NonUnit,
+                  X.nrow(), X.ncol(), 1.0, L.data(), L.nrow(),
+                  X.data(), X.nrow());
+    }
+  }  // namespace
+
+  //======================================================================
+  KroneckerProduct::KroneckerProduct(const Matrix &A, const Matrix &B)
+      : A_(A), B_(B)
+  {}
+
+  Matrix KroneckerProduct::multiply(const Matrix &X)const{
+    if(X.nrow() != B_.ncol() || X.ncol() != A_.ncol()){
+      report_error("Wrong sized argument to KroneckerProduct::multiply.");
+    }
+    return B_ * X.multT(A_);
+  }
+
+  Vector KroneckerProduct::operator*(const Vector &v)const{
+    if(v.size() != ncol()){
+      report_error("Wrong sized argument to KroneckerProduct::operator*.");
+    }
+    Matrix ans = multiply(Matrix(B_.ncol(), A_.ncol(), v.data()));
+    return Vector(ans.begin(), ans.end());
+  }
+
+  Matrix KroneckerProduct::Tmult(const Matrix &X)const{
+    if(X.nrow() != B_.nrow() || X.ncol() != A_.nrow()){
+      report_error("Wrong sized argument to KroneckerProduct::Tmult.");
+    }
+    return B_.Tmult(X) * A_;
+  }
+
+  Vector KroneckerProduct::Tmult(const Vector &v)const{
+    if(v.size() != nrow()){
+      report_error("Wrong sized argument to KroneckerProduct::Tmult.");
+    }
+    Matrix ans = Tmult(Matrix(B_.nrow(), A_.nrow(), v.data()));
+    return Vector(ans.begin(), ans.end());
+  }
+
+  Matrix KroneckerProduct::dense()const{
+    return Kronecker(A_, B_);
+  }
+
+  //======================================================================
+  typedef SpdKroneckerProduct SKP;
+
+  SKP::SpdKroneckerProduct(const SpdMatrix &A, const SpdMatrix &B){
+    Chol A_chol(A);
+    Chol B_chol(B);
+    if(!A_chol.is_pos_def() || !B_chol.is_pos_def()){
+      report_error("SpdKroneckerProduct needs positive definite factors.");
     }
+    LA_ = A_chol.getL();
+    LB_ = B_chol.getL();
+    logdet_A_ = A_chol.logdet();
+    logdet_B_ = B_chol.logdet();
+  }
+
+  SKP::SpdKroneckerProduct(const Chol &A_chol, const Chol &B_chol)
+      : LA_(A_chol.getL()),
+        LB_(B_chol.getL()),
+        logdet_A_(A_chol.logdet()),
+        logdet_B_(B_chol.logdet())
+  {
+    if(!A_chol.is_pos_def() || !B_chol.is_pos_def()){
+      report_error("SpdKroneckerProduct needs positive definite factors.");
+    }
+  }
+
+  void SKP::check_shape(const Matrix &X)const{
+    if(X.nrow() != LB_.nrow() || X.ncol() != LA_.nrow()){
+      report_error("Argument to SpdKroneckerProduct must have dim(B) rows "
+                   "and dim(A) columns.");
+    }
+  }
+
+  Matrix SKP::reshape(const Vector &v)const{
+    if(v.size() != dim()){
+      report_error("Wrong sized argument to SpdKroneckerProduct.");
+    }
+    return Matrix(LB_.nrow(), LA_.nrow(), v.data());
+  }
+
+  Matrix SKP::multiply(const Matrix &X)const{
+    check_shape(X);
+    Matrix ans(X);
+    triangular_multiply(blas::Left, blas::Trans, LB_, ans);
+    triangular_multiply(blas::Left, blas::NoTrans, LB_, ans);
+    triangular_multiply(blas::Right, blas::NoTrans, LA_, ans);
+    triangular_multiply(blas::Right, blas::Trans, LA_, ans);
     return ans;
   }
+
+  Vector SKP::operator*(const Vector &v)const{
+    Matrix ans = multiply(reshape(v));
+    return Vector(ans.begin(), ans.end());
+  }
+
+  Matrix SKP::solve(const Matrix &X)const{
+    check_shape(X);
+    Matrix ans(X);
+    triangular_solve(blas::Left, blas::NoTrans, LB_, ans);
+    triangular_solve(blas::Left, blas::Trans, LB_, ans);
+    triangular_solve(blas::Right, blas::Trans, LA_, ans);
+    triangular_solve(blas::Right, blas::NoTrans, LA_, ans);
+    return ans;
+  }
+
+  Vector SKP::solve(const Vector &v)const{
+    Matrix ans = solve(reshape(v));
+    return Vector(ans.begin(), ans.end());
+  }
+
+  double SKP::logdet()const{
+    return LB_.nrow() * logdet_A_ + LA_.nrow() * logdet_B_;
+  }
+
+  Matrix SKP::Lmult(const Matrix &X)const{
+    check_shape(X);
+    Matrix ans(X);
+    triangular_multiply(blas::Left, blas::NoTrans, LB_, ans);
+    triangular_multiply(blas::Right, blas::Trans, LA_, ans);
+    return ans;
+  }
+
+  Matrix SKP::LTsolve(const Matrix &X)const{
+    check_shape(X);
+    Matrix ans(X);
+    triangular_solve(blas::Left, blas::Trans, LB_, ans);
+    triangular_solve(blas::Right, blas::NoTrans, LA_, ans);
+    return ans;
+  }
+
+  namespace {
+    Matrix standard_normal_matrix(RNG &rng, uint nrow, uint ncol){
+      Matrix Z(nrow, ncol);
+      double *z = Z.data();
+      for(uint i = 0; i < nrow * ncol; ++i) z[i] = rnorm_mt(rng);
+      return Z;
+    }
+  }  // namespace
+
+  Matrix SKP::rmvn(RNG &rng, const Matrix &Mu)const{
+    check_shape(Mu);
+    Matrix ans = Lmult(standard_normal_matrix(rng, Mu.nrow(), Mu.ncol()));
+    ans += Mu;
+    return ans;
+  }
+
+  Matrix SKP::rmvn_ivar(RNG &rng, const Matrix &Mu)const{
+    check_shape(Mu);
+    Matrix ans = LTsolve(standard_normal_matrix(rng, Mu.nrow(), Mu.ncol()));
+    ans += Mu;
+    return ans;
+  }
+
+  SpdMatrix SKP::dense()const{
+    return SpdMatrix(Kronecker(LA_.multT(LA_), LB_.multT(LB_)), false);
+  }
 }
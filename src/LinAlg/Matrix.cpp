@@ -25,6 +25,7 @@
 #include <sstream>
 #include <algorithm>
 #include <functional>
+#include <utility>
 #include <vector>
 #include <string>
 
@@ -1029,6 +1030,74 @@ namespace BOOM{
     return ans;
   }
 
+  //----------------------------------------------------------------------
+  Matrix operator+(Matrix &&x, const Matrix &y) {
+    x += y;
+    return std::move(x);
+  }
+  Matrix operator+(const Matrix &x, Matrix &&y) {
+    y += x;
+    return std::move(y);
+  }
+  Matrix operator+(Matrix &&x, Matrix &&y) {
+    x += y;
+    return std::move(x);
+  }
+  Matrix operator-(Matrix &&x, const Matrix &y) {
+    x -= y;
+    return std::move(x);
+  }
+  Matrix operator-(const Matrix &x, Matrix &&y) {
+    assert(x.same_dim(y));
+    const double *xd = x.data();
+    double *yd = y.data();
+    for (uint i = 0; i < y.size(); ++i) yd[i] = xd[i] - yd[i];
+    return std::move(y);
+  }
+  Matrix operator-(Matrix &&x, Matrix &&y) {
+    x -= y;
+    return std::move(x);
+  }
+
+  Matrix operator+(Matrix &&x, double y) {
+    x += y;
+    return std::move(x);
+  }
+  Matrix operator+(double y, Matrix &&x) {
+    x += y;
+    return std::move(x);
+  }
+  Matrix operator-(Matrix &&x, double y) {
+    x -= y;
+    return std::move(x);
+  }
+  Matrix operator-(double y, Matrix &&x) {
+    double *d = x.data();
+    for (uint i = 0; i < x.size(); ++i) d[i] = y - d[i];
+    return std::move(x);
+  }
+  Matrix operator*(Matrix &&x, double y) {
+    x *= y;
+    return std::move(x);
+  }
+  Matrix operator*(double y, Matrix &&x) {
+    x *= y;
+    return std::move(x);
+  }
+  Matrix operator/(Matrix &&x, double y) {
+    x /= y;
+    return std::move(x);
+  }
+  Matrix operator/(double y, Matrix &&x) {
+    double *d = x.data();
+    for (uint i = 0; i < x.size(); ++i) d[i] = y / d[i];
+    return std::move(x);
+  }
+  Matrix operator-(Matrix &&x) {
+    x *= -1;
+    return std::move(x);
+  }
+
   inline double mul(double x, double y) {return x*y;}
 
   Matrix el_mult(const Matrix &A, const Matrix &B) {
@@ -18,6 +18,9 @@
 
 #include <LinAlg/SWEEP.hpp>
 #include <LinAlg/Types.hpp>
+#include <LinAlg/Cholesky.hpp>
+#include <distributions.hpp>
+#include <cpputil/report_error.hpp>
 
 namespace BOOM{
   typedef SweptVarianceMatrix SVM;
@@ -49,38 +52,39 @@ namespace BOOM{
     if(swept_[m]) return;
     ++nswept_;
     swept_[m]=true;
-    double x = S(m,m);
-    uint d = S.dim();
-    for(uint i=0; i<d; ++i){
-      if(i!=m){
-        for(uint j = 0; j<d; ++j){
-          if(j!=m){
-            S(i,j) -= S(i,m)*S(m,j)/x; }}}}
-    S(m,m) = -1.0/x;
-    for(uint i = 0; i<d; ++i){
-      if(i!=m){
-        S(i,m)/=x;
-        S(m,i)/=x;}}
+    sweep_element(m, 1.0);
   }
 
   void SVM::RSW(uint m){
     if(!swept_[m]) return;
     --nswept_;
     swept_[m]=false;
+    sweep_element(m, -1.0);
+  }
 
-    double x = S(m,m);
+  // SWP and RSW differ only in the sign of row and column m.  S is
+  // kept symmetric, so S(m, j) == S(j, m), and the update runs down
+  // the columns of S.
+  void SVM::sweep_element(uint m, double sign){
     uint d = S.dim();
-    for(uint i=0; i<d; ++i){
-      if(i!=m){
-        for(uint j = 0; j<d; ++j){
-          if(j!=m){
-            S(i,j) -=  S(i,m)*S(m,j)/x; }}}}
-
-    S(m,m) = -1.0/x;
+    double x = S(m,m);
+    double *data = S.data();
+    const double *col_m = data + m * d;
+    for(uint j = 0; j<d; ++j){
+      if(j==m) continue;
+      double *col_j = data + j * d;
+      double factor = col_m[j] / x;
+      // Row m is overwritten below, so it needn't be skipped here.
+      for(uint i = 0; i<d; ++i){
+        col_j[i] -= col_m[i] * factor;
+      }
+    }
+    double scale = sign / x;
     for(uint i = 0; i<d; ++i){
       if(i!=m){
-        S(i,m)/=x;
-        S(m,i)/=x;}}
+        S(i,m) *= scale;
+        S(m,i) = S(i,m);}}
+    S(m,m) = -1.0/x;
   }
 
   uint SVM::xdim()const{ return nswept_; }
@@ -98,7 +102,6 @@ namespace BOOM{
         for(uint j = 0; j<S.dim(); ++j){
           if(swept_[j]==false)     // j is a 'y' dimension
             ans(ii,jj++)=S(i,j);}
-        if(jj==ydim()) break;
         ++ii;}
       if(ii==xdim()) break; }
     return ans; }
@@ -106,9 +109,9 @@ namespace BOOM{
   Vector SVM::E_y_given_x(const Vector &x, const Vector &mu){
     assert(mu.size()==S.ncol());
     assert(x.size() == nswept_);
-    std::vector<bool> isy(swept_);
-    isy.flip();
-    return x * Beta() + select(mu, isy);
+    Selector isx(swept_);
+    Vector x_deviation = x - isx.select(mu);
+    return x_deviation * Beta() + isx.complement().select(mu);
   }
   //------------------------------------------------------------
 
@@ -117,10 +120,10 @@ namespace BOOM{
     uint ii=0;
     uint d = S.dim();
     for(uint i = 0; i<d; ++i){
-      if(swept_[i]==true){
+      if(swept_[i]==false){
         uint jj=0;
         for(uint j  = 0; j<=i; ++j){
-          if(swept_[j]==true){
+          if(swept_[j]==false){
             ans(ii,jj) = ans(jj,ii) = S(i,j);
             ++jj;}}
         ++ii;}}
@@ -140,4 +143,166 @@ namespace BOOM{
         ++ii;}}
     return ans;}
 
+  //======================================================================
+  typedef SweptVarianceCache SVC;
+
+  namespace {
+    // The positions of the included and excluded elements of inc.
+    void split_positions(const std::vector<bool> &inc,
+                         std::vector<uint> &included,
+                         std::vector<uint> &excluded){
+      included.clear();
+      excluded.clear();
+      for(std::size_t i = 0; i < inc.size(); ++i){
+        if(inc[i]) included.push_back(i);
+        else excluded.push_back(i);
+      }
+    }
+  }  // namespace
+
+  SVC::SweptVarianceCache(const SpdMatrix &Sigma, int max_patterns)
+      : Sigma_(Sigma),
+        max_patterns_(max_patterns)
+  {
+    if(max_patterns < 1){
+      report_error("SweptVarianceCache needs room for at least one pattern.");
+    }
+  }
+
+  void SVC::set_variance(const SpdMatrix &Sigma){
+    Sigma_ = Sigma;
+    entries_.clear();
+    index_.clear();
+  }
+
+  SVC::Entry & SVC::find(const Selector &observed){
+    uint d = Sigma_.nrow();
+    if(observed.nvars_possible() != d){
+      report_error("Pattern size does not match the variance matrix "
+                   "in SweptVarianceCache.");
+    }
+    std::map<Selector, EntryList::iterator>::iterator it =
+        index_.find(observed);
+    if(it != index_.end()){
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return entries_.front();
+    }
+
+    // Start from the cached pattern needing the fewest sweeps, or
+    // from Sigma if sweeping from scratch is cheaper.
+    const SweptVarianceMatrix *start = 0;
+    uint fewest_sweeps = observed.nvars();
+    for(EntryList::const_iterator e = entries_.begin();
+        e != entries_.end(); ++e){
+      uint sweeps = observed.exclusive_or(e->observed).nvars();
+      if(sweeps < fewest_sweeps){
+        fewest_sweeps = sweeps;
+        start = &e->swept;
+      }
+    }
+
+    Entry entry;
+    entry.observed = observed;
+    entry.swept = start ? *start : SweptVarianceMatrix(Sigma_);
+    entry.swept.SWP(observed);
+
+    std::vector<uint> obs, mis;
+    split_positions(observed, obs, mis);
+    const SpdMatrix &S(entry.swept.swept_matrix());
+    entry.beta.resize(obs.size(), mis.size());
+    for(std::size_t j = 0; j < mis.size(); ++j){
+      for(std::size_t i = 0; i < obs.size(); ++i){
+        entry.beta(i, j) = S(obs[i], mis[j]);
+      }
+    }
+    entry.conditional_variance.resize(mis.size());
+    for(std::size_t j = 0; j < mis.size(); ++j){
+      for(std::size_t i = 0; i < mis.size(); ++i){
+        entry.conditional_variance(i, j) = S(mis[i], mis[j]);
+      }
+    }
+    if(!mis.empty()){
+      Chol chol(entry.conditional_variance);
+      if(!chol.is_pos_def()){
+        report_error("Conditional variance is not positive definite "
+                     "in SweptVarianceCache.");
+      }
+      entry.conditional_variance_cholesky = chol.getL();
+    }
+
+    if(entries_.size() >= max_patterns_){
+      index_.erase(entries_.back().observed);
+      entries_.pop_back();
+    }
+    entries_.push_front(entry);
+    index_[observed] = entries_.begin();
+    return entries_.front();
+  }
+
+  const SweptVarianceMatrix & SVC::swept(const Selector &observed){
+    return find(observed).swept;
+  }
+
+  const SpdMatrix & SVC::conditional_variance(const Selector &observed){
+    return find(observed).conditional_variance;
+  }
+
+  Vector SVC::conditional_mean(const Vector &y, const Vector &mu,
+                               const Selector &observed){
+    const Entry &entry(find(observed));
+    Vector ans = observed.complement().select(mu);
+    if(observed.nvars() > 0 && !ans.empty()){
+      Vector x = observed.select(y) - observed.select(mu);
+      ans += x * entry.beta;
+    }
+    return ans;
+  }
+
+  void SVC::impute_rows(RNG &rng, Matrix &Y, const Vector &mu,
+                        const std::vector<Selector> &observed){
+    uint n = Y.nrow();
+    uint d = Sigma_.nrow();
+    if(static_cast<uint>(observed.size()) != n || Y.ncol() != d
+       || static_cast<uint>(mu.size()) != d){
+      report_error("Wrong sized arguments to SweptVarianceCache::"
+                   "impute_rows.");
+    }
+    typedef std::map<Selector, std::vector<uint> > GroupMap;
+    GroupMap groups;
+    for(uint i = 0; i < n; ++i){
+      if(observed[i].nvars() < d) groups[observed[i]].push_back(i);
+    }
+
+    std::vector<uint> obs, mis;
+    for(GroupMap::const_iterator it = groups.begin();
+        it != groups.end(); ++it){
+      const Entry &entry(find(it->first));
+      const std::vector<uint> &rows(it->second);
+      split_positions(it->first, obs, mis);
+      uint group_size = rows.size();
+
+      Matrix z(group_size, mis.size());
+      for(std::size_t j = 0; j < mis.size(); ++j){
+        for(uint k = 0; k < group_size; ++k){
+          z(k, j) = rnorm_mt(rng);
+        }
+      }
+      Matrix imputed = z.multT(entry.conditional_variance_cholesky);
+      if(!obs.empty()){
+        Matrix x(group_size, obs.size());
+        for(std::size_t j = 0; j < obs.size(); ++j){
+          for(uint k = 0; k < group_size; ++k){
+            x(k, j) = Y(rows[k], obs[j]) - mu[obs[j]];
+          }
+        }
+        imputed += x * entry.beta;
+      }
+      for(std::size_t j = 0; j < mis.size(); ++j){
+        for(uint k = 0; k < group_size; ++k){
+          Y(rows[k], mis[j]) = imputed(k, j) + mu[mis[j]];
+        }
+      }
+    }
+  }
+
 } // ends namespace BOOM
@@ -20,6 +20,7 @@
 #include <LinAlg/Matrix.hpp>
 #include <LinAlg/Vector.hpp>
 #include <LinAlg/Cholesky.hpp>
+#include <LinAlg/FixedMatrix.hpp>
 #include <LinAlg/LU.hpp>
 #include <LinAlg/SubMatrix.hpp>
 #include <LinAlg/blas.hpp>
@@ -28,6 +29,7 @@
 #include <cpputil/report_error.hpp>
 
 #include <cmath>
+#include <utility>
 #include <numeric>
 #include <stdexcept>
 #include <sstream>
@@ -188,6 +190,13 @@ namespace BOOM{
 
    Matrix SpdMatrix::chol()const{ bool ok=true; return chol(ok);}
    Matrix SpdMatrix::chol(bool &ok)const{
+     int dim = nrow();
+     if (dim > 0 && dim <= max_fixed_matrix_dimension) {
+       // Tiny matrices are cheaper to factor without LAPACK.
+       Matrix L(dim, dim);
+       ok = fixed_cholesky(dim, data(), L.data());
+       return L;
+     }
      SpdMatrix ans(*this);
      ans.reflect();
      int n = ans.nrow();
@@ -830,6 +839,18 @@ namespace BOOM{
    SpdMatrix operator/(const SpdMatrix &v, double x){
      return v*(1.0/x); }
 
+   SpdMatrix operator*(double x, SpdMatrix &&V){
+     assert(x>=0);
+     V*=x;
+     return std::move(V);
+   }
+
+   SpdMatrix operator*(SpdMatrix &&V, double x){
+     return x*std::move(V); }
+
+   SpdMatrix operator/(SpdMatrix &&V, double x){
+     return std::move(V)*(1.0/x); }
+
   SpdMatrix symmetric_square_root(const SpdMatrix &V) {
     Matrix eigenvectors(V.nrow(), V.nrow());
     Vector eigenvalues = eigen(V, eigenvectors);
@@ -27,8 +27,10 @@
 #include <stdexcept>
 #include <cmath>
 #include <numeric>
+#include <utility>
 #include <functional>
 
+#include <cpputil/lse.hpp>
 #include <cpputil/math_utils.hpp>
 #include <cpputil/string_utils.hpp>
 #include <cpputil/report_error.hpp>
@@ -58,7 +60,12 @@ namespace BOOM{
 
   Vector::Vector() : dVector() {}
 
-  Vector::Vector(uint n, double x) : dVector(n, x) {}
+  // The constructors that know the size in advance take storage from
+  // the active WorkspaceRegion, if there is one.
+  Vector::Vector(uint n, double x) {
+    workspace::reserve(*this, n);
+    assign(n, x);
+  }
 
   Vector::Vector(const string &s)
   {
@@ -101,17 +108,20 @@ namespace BOOM{
       : dVector(rhs)
   {}
 
-  Vector::Vector(const Vector &rhs)
-      : dVector(rhs)
-  {}
+  Vector::Vector(const Vector &rhs) {
+    workspace::reserve(*this, rhs.size());
+    assign(rhs.begin(), rhs.end());
+  }
 
-  Vector::Vector(const VectorView &rhs)
-      : dVector(rhs.begin(), rhs.end())
-  {}
+  Vector::Vector(const VectorView &rhs) {
+    workspace::reserve(*this, rhs.size());
+    assign(rhs.begin(), rhs.end());
+  }
 
-  Vector::Vector(const ConstVectorView &rhs)
-      : dVector(rhs.begin(), rhs.end())
-  {}
+  Vector::Vector(const ConstVectorView &rhs) {
+    workspace::reserve(*this, rhs.size());
+    assign(rhs.begin(), rhs.end());
+  }
 
   Vector & Vector::operator=(const Vector &rhs){
     if(&rhs!=this) dVector::operator=(rhs);
@@ -376,14 +386,9 @@ namespace BOOM{
   }
 
   Vector & Vector::normalize_logprob(){
-    double nc=0;
-    Vector &x= *this;
     double m = max();
-    uint n = size();
-    for(uint i=0; i<n; ++i){
-      x[i] = std::exp(x[i]-m);
-      nc+=x[i]; }
-    x/=nc;
+    double nc = exp_shifted(data(), m, data(), size());
+    (*this)/=nc;
     return *this;   // might want to change this
   }
 
@@ -586,25 +591,29 @@ namespace BOOM{
     template <class V1, class V2>
     Vector vector_add(const V1 &v1, const V2 &v2) {
       Vector v(v1);
-      return v += v2;
+      v += v2;
+      return v;
     }
 
     template <class V1, class V2>
     Vector vector_subtract(const V1 &v1, const V2 &v2) {
       Vector v(v1);
-      return v -= v2;
+      v -= v2;
+      return v;
     }
 
     template <class V1, class V2>
     Vector vector_multiply(const V1 &v1, const V2 &v2) {
       Vector v(v1);
-      return v *= v2;
+      v *= v2;
+      return v;
     }
 
     template <class V1, class V2>
     Vector vector_divide(const V1 &v1, const V2 &v2) {
       Vector v(v1);
-      return v /= v2;
+      v /= v2;
+      return v;
     }
   }
 
@@ -660,51 +669,239 @@ namespace BOOM{
     return vector_divide(x, y);
   }
 
+  //----------------------------------------------------------------------
+  // Operators with a temporary operand reuse its storage.
+  namespace {
+    // Overwrite y with x - y.
+    template <class V>
+    Vector reverse_subtract(const V &x, Vector &&y) {
+      assert(x.size() == y.size());
+      for(uint i=0; i<y.size(); ++i) y[i] = x[i] - y[i];
+      return std::move(y);
+    }
+
+    // Overwrite y with x / y.
+    template <class V>
+    Vector reverse_divide(const V &x, Vector &&y) {
+      assert(x.size() == y.size());
+      for(uint i=0; i<y.size(); ++i) y[i] = x[i] / y[i];
+      return std::move(y);
+    }
+  }
+
+  Vector operator+(Vector &&x, const Vector &y) {
+    x += y;
+    return std::move(x);
+  }
+  Vector operator+(const Vector &x, Vector &&y) {
+    y += x;
+    return std::move(y);
+  }
+  Vector operator+(Vector &&x, Vector &&y) {
+    x += y;
+    return std::move(x);
+  }
+  Vector operator+(Vector &&x, const VectorView &y) {
+    x += y;
+    return std::move(x);
+  }
+  Vector operator+(const VectorView &x, Vector &&y) {
+    y += x;
+    return std::move(y);
+  }
+  Vector operator+(Vector &&x, const ConstVectorView &y) {
+    x += y;
+    return std::move(x);
+  }
+  Vector operator+(const ConstVectorView &x, Vector &&y) {
+    y += x;
+    return std::move(y);
+  }
+
+  Vector operator-(Vector &&x, const Vector &y) {
+    x -= y;
+    return std::move(x);
+  }
+  Vector operator-(const Vector &x, Vector &&y) {
+    return reverse_subtract(x, std::move(y));
+  }
+  Vector operator-(Vector &&x, Vector &&y) {
+    x -= y;
+    return std::move(x);
+  }
+  Vector operator-(Vector &&x, const VectorView &y) {
+    x -= y;
+    return std::move(x);
+  }
+  Vector operator-(const VectorView &x, Vector &&y) {
+    return reverse_subtract(x, std::move(y));
+  }
+  Vector operator-(Vector &&x, const ConstVectorView &y) {
+    x -= y;
+    return std::move(x);
+  }
+  Vector operator-(const ConstVectorView &x, Vector &&y) {
+    return reverse_subtract(x, std::move(y));
+  }
+
+  Vector operator*(Vector &&x, const Vector &y) {
+    x *= y;
+    return std::move(x);
+  }
+  Vector operator*(const Vector &x, Vector &&y) {
+    y *= x;
+    return std::move(y);
+  }
+  Vector operator*(Vector &&x, Vector &&y) {
+    x *= y;
+    return std::move(x);
+  }
+  Vector operator*(Vector &&x, const VectorView &y) {
+    x *= y;
+    return std::move(x);
+  }
+  Vector operator*(const VectorView &x, Vector &&y) {
+    y *= x;
+    return std::move(y);
+  }
+  Vector operator*(Vector &&x, const ConstVectorView &y) {
+    x *= y;
+    return std::move(x);
+  }
+  Vector operator*(const ConstVectorView &x, Vector &&y) {
+    y *= x;
+    return std::move(y);
+  }
+
+  Vector operator/(Vector &&x, const Vector &y) {
+    x /= y;
+    return std::move(x);
+  }
+  Vector operator/(const Vector &x, Vector &&y) {
+    return reverse_divide(x, std::move(y));
+  }
+  Vector operator/(Vector &&x, Vector &&y) {
+    x /= y;
+    return std::move(x);
+  }
+  Vector operator/(Vector &&x, const VectorView &y) {
+    x /= y;
+    return std::move(x);
+  }
+  Vector operator/(const VectorView &x, Vector &&y) {
+    return reverse_divide(x, std::move(y));
+  }
+  Vector operator/(Vector &&x, const ConstVectorView &y) {
+    x /= y;
+    return std::move(x);
+  }
+  Vector operator/(const ConstVectorView &x, Vector &&y) {
+    return reverse_divide(x, std::move(y));
+  }
+
+  Vector operator+(Vector &&x, double a) {
+    x += a;
+    return std::move(x);
+  }
+  Vector operator+(double a, Vector &&x) {
+    x += a;
+    return std::move(x);
+  }
+  Vector operator-(Vector &&x, double a) {
+    x -= a;
+    return std::move(x);
+  }
+  Vector operator-(double a, Vector &&x) {
+    for(uint i=0; i<x.size(); ++i) x[i] = a - x[i];
+    return std::move(x);
+  }
+  Vector operator*(Vector &&x, double a) {
+    x *= a;
+    return std::move(x);
+  }
+  Vector operator*(double a, Vector &&x) {
+    x *= a;
+    return std::move(x);
+  }
+  Vector operator/(Vector &&x, double a) {
+    x /= a;
+    return std::move(x);
+  }
+  Vector operator/(double a, Vector &&x) {
+    for(uint i=0; i<x.size(); ++i) x[i] = a / x[i];
+    return std::move(x);
+  }
+
   // unary transformations
   Vector operator-(const Vector &x){
     Vector ans = x;
-    return ans.operator*=(-1);
+    ans *= -1;
+    return ans;
+  }
+  Vector operator-(Vector &&x){
+    x *= -1;
+    return std::move(x);
   }
 
   namespace {
-  //    template <class VECTOR>
-  //    Vector vector_transform(const VECTOR &x,
-    Vector vector_transform(const ConstVectorView &x,
-                            std::function<double(double)> f) {
+    // The transformation is a template argument, rather than a
+    // std::function, so that it can be inlined into the loop.
+    template <class F>
+    Vector vector_transform(const ConstVectorView &x, F f) {
       Vector ans(x.size());
       std::transform(x.begin(), x.end(), ans.begin(), f);
       return ans;
     }
+
+    template <class F>
+    Vector transform_in_place(Vector &&x, F f) {
+      std::transform(x.begin(), x.end(), x.begin(), f);
+      return std::move(x);
+    }
+
+    inline double log_fun(double x) {return std::log(x);}
+    inline double exp_fun(double x) {return std::exp(x);}
+    inline double sqrt_fun(double x) {return std::sqrt(x);}
+    inline double abs_fun(double x) {return std::fabs(x);}
   }
 
   Vector log(const Vector &x){
-    return vector_transform(x, ::log);
+    return vector_transform(x, log_fun);
   }
   Vector log(const VectorView &x){
-    return vector_transform(x, ::log);
+    return vector_transform(x, log_fun);
   }
   Vector log(const ConstVectorView &x){
-    return vector_transform(x, ::log);
+    return vector_transform(x, log_fun);
+  }
+  Vector log(Vector &&x){
+    return transform_in_place(std::move(x), log_fun);
   }
 
   Vector exp(const Vector &x){
-    return vector_transform(x, ::exp);
+    return vector_transform(x, exp_fun);
   }
   Vector exp(const VectorView &x){
-    return vector_transform(x, ::exp);
+    return vector_transform(x, exp_fun);
   }
   Vector exp(const ConstVectorView &x){
-    return vector_transform(x, ::exp);
+    return vector_transform(x, exp_fun);
+  }
+  Vector exp(Vector &&x){
+    return transform_in_place(std::move(x), exp_fun);
   }
 
   Vector sqrt(const Vector &x){
-    return vector_transform(x, ::sqrt);
+    return vector_transform(x, sqrt_fun);
   }
   Vector sqrt(const VectorView &x){
-    return vector_transform(x, ::sqrt);
+    return vector_transform(x, sqrt_fun);
   }
   Vector sqrt(const ConstVectorView &x){
-    return vector_transform(x, ::sqrt);
+    return vector_transform(x, sqrt_fun);
+  }
+  Vector sqrt(Vector &&x){
+    return transform_in_place(std::move(x), sqrt_fun);
   }
 
   Vector pow(const Vector &x, double power){
@@ -719,6 +916,10 @@ namespace BOOM{
     return vector_transform(x, [power](double x)->double{
         return std::pow(x, power);});
   }
+  Vector pow(Vector &&x, double power){
+    return transform_in_place(std::move(x), [power](double x)->double{
+        return std::pow(x, power);});
+  }
 
   Vector pow(const Vector &x, int power){
     return vector_transform(x, [power](double x)->double{
@@ -732,15 +933,22 @@ namespace BOOM{
     return vector_transform(x, [power](double x)->double{
         return std::pow(x, power);});
   }
+  Vector pow(Vector &&x, int power){
+    return transform_in_place(std::move(x), [power](double x)->double{
+        return std::pow(x, power);});
+  }
 
   Vector abs(const Vector &x) {
-    return vector_transform(x, ::fabs);
+    return vector_transform(x, abs_fun);
   }
   Vector abs(const VectorView &x) {
-    return vector_transform(x, ::fabs);
+    return vector_transform(x, abs_fun);
   }
   Vector abs(const ConstVectorView &x) {
-    return vector_transform(x, ::fabs);
+    return vector_transform(x, abs_fun);
+  }
+  Vector abs(Vector &&x) {
+    return transform_in_place(std::move(x), abs_fun);
   }
 
   namespace {
@@ -0,0 +1,126 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <LinAlg/Workspace.hpp>
+
+namespace BOOM{
+
+  namespace workspace {
+    std::atomic<int> threads_with_active_regions(0);
+  }  // namespace workspace
+
+  namespace {
+    // Blocks are kept in bins by size.  Bin b holds blocks with
+    // capacity in [2^b, 2^(b+1)).  Requests for n elements are served
+    // from bin ceil(log2(n)), so any block in the bin is big enough.
+    // Blocks allocated by the pool have capacity exactly 2^b.
+    const int number_of_bins = 40;
+
+    // Blocks beyond this number in a bin are freed rather than
+    // pooled, to bound the memory held by the pool.
+    const std::size_t max_blocks_per_bin = 256;
+
+    struct Pool {
+      Pool() : depth(0) {}
+      int depth;
+      WorkspaceRegion::Counts counts;
+      std::vector<std::vector<double> > bins[number_of_bins];
+    };
+
+    Pool &pool() {
+      thread_local Pool thread_pool;
+      return thread_pool;
+    }
+
+    // The largest b with 2^b <= n, for n > 0.
+    int floor_log2(std::size_t n) {
+      int ans = 0;
+      while (n >>= 1) ++ans;
+      return ans;
+    }
+
+    // The smallest b with 2^b >= n, for n > 0.
+    int ceiling_log2(std::size_t n) {
+      int ans = floor_log2(n);
+      return (std::size_t(1) << ans) < n ? ans + 1 : ans;
+    }
+  }  // namespace
+
+  WorkspaceRegion::WorkspaceRegion() {
+    Pool &p(pool());
+    if (p.depth++ == 0) {
+      p.counts.recycled = 0;
+      p.counts.allocated = 0;
+      p.counts.returned = 0;
+      ++workspace::threads_with_active_regions;
+    }
+  }
+
+  WorkspaceRegion::~WorkspaceRegion() {
+    Pool &p(pool());
+    if (--p.depth == 0) {
+      --workspace::threads_with_active_regions;
+      for (int b = 0; b < number_of_bins; ++b) {
+        std::vector<std::vector<double> >().swap(p.bins[b]);
+      }
+    }
+  }
+
+  WorkspaceRegion::Counts WorkspaceRegion::counts() const {
+    return pool().counts;
+  }
+
+  bool WorkspaceRegion::active() {
+    return workspace::any_regions_active() && pool().depth > 0;
+  }
+
+  namespace workspace {
+    void reserve(std::vector<double> &v, std::size_t n) {
+      if (n == 0 || !any_regions_active()) return;
+      Pool &p(pool());
+      if (p.depth == 0) return;
+      int b = ceiling_log2(n);
+      if (b >= number_of_bins) return;
+      std::vector<std::vector<double> > &bin(p.bins[b]);
+      if (bin.empty()) {
+        v.reserve(std::size_t(1) << b);
+        ++p.counts.allocated;
+      } else {
+        v.swap(bin.back());
+        bin.pop_back();
+        ++p.counts.recycled;
+      }
+    }
+
+    void release(std::vector<double> &v) {
+      std::size_t capacity = v.capacity();
+      if (capacity == 0 || !any_regions_active()) return;
+      Pool &p(pool());
+      if (p.depth == 0) return;
+      int b = floor_log2(capacity);
+      if (b >= number_of_bins) return;
+      std::vector<std::vector<double> > &bin(p.bins[b]);
+      if (bin.size() >= max_blocks_per_bin) return;
+      bin.emplace_back();
+      bin.back().swap(v);
+      bin.back().clear();
+      ++p.counts.returned;
+    }
+  }  // namespace workspace
+
+}  // namespace BOOM
@@ -1,4 +1,6 @@
 #include <LinAlg/blas.hpp>
+#include <chrono>
+#include <vector>
 
 extern "C" {
 
@@ -204,11 +206,143 @@ namespace BOOM {
     const char SideChar[2][2] = {"L", "R"};
     const char DiagChar[2][2] = {"N", "U"};
 
+    namespace {
+      // Crossover points measured against a threaded OpenBLAS on
+      // x86-64.  The reference BLAS shipped with R is slower for
+      // small problems, so these are conservative there.  See
+      // calibrate_small_kernel_thresholds() to measure them on
+      // another machine.
+      SmallKernelThresholds thresholds = {64, 100, 27, 512};
+
+      // The kernels below handle positive increments only.  Negative
+      // increments, which BOOM does not produce, go to the BLAS.
+
+      // Dot product with four accumulators, so the unit stride case
+      // can be vectorized.
+      double small_ddot(int n, const double *x, int incx,
+                        const double *y, int incy) {
+        if (incx == 1 && incy == 1) {
+          double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+          int i = 0;
+          for (; i + 4 <= n; i += 4) {
+            s0 += x[i] * y[i];
+            s1 += x[i + 1] * y[i + 1];
+            s2 += x[i + 2] * y[i + 2];
+            s3 += x[i + 3] * y[i + 3];
+          }
+          for (; i < n; ++i) s0 += x[i] * y[i];
+          return (s0 + s1) + (s2 + s3);
+        }
+        double ans = 0;
+        for (int i = 0; i < n; ++i) ans += x[i * incx] * y[i * incy];
+        return ans;
+      }
+
+      // y = beta * y, with y set to zero (rather than multiplied by
+      // zero) if beta is zero, as in the reference BLAS.
+      void scale(int n, double beta, double *y, int incy) {
+        if (beta == 1.0) return;
+        if (beta == 0.0) {
+          for (int i = 0; i < n; ++i) y[i * incy] = 0.0;
+        } else {
+          for (int i = 0; i < n; ++i) y[i * incy] *= beta;
+        }
+      }
+
+      // y += alpha * x, for unit stride x.
+      void axpy(int n, double alpha, const double *x, double *y, int incy) {
+        if (incy == 1) {
+          for (int i = 0; i < n; ++i) y[i] += alpha * x[i];
+        } else {
+          for (int i = 0; i < n; ++i) y[i * incy] += alpha * x[i];
+        }
+      }
+
+      void small_dgemv(TRANSPOSE trans, int m, int n, double alpha,
+                       const double *A, int lda, const double *x, int incx,
+                       double beta, double *y, int incy) {
+        if (m == 0 || n == 0) return;
+        if (trans == NoTrans) {
+          scale(m, beta, y, incy);
+          if (alpha == 0.0) return;
+          for (int j = 0; j < n; ++j) {
+            axpy(m, alpha * x[j * incx], A + j * lda, y, incy);
+          }
+        } else {
+          for (int j = 0; j < n; ++j) {
+            double total = alpha * small_ddot(m, A + j * lda, 1, x, incx);
+            double &yj(y[j * incy]);
+            yj = beta == 0.0 ? total : beta * yj + total;
+          }
+        }
+      }
+
+      // C = alpha * op(A) * op(B) + beta * C, with C m x n and k the
+      // inner dimension.
+      void small_dgemm(TRANSPOSE transa, TRANSPOSE transb,
+                       int m, int n, int k, double alpha,
+                       const double *A, int lda, const double *B, int ldb,
+                       double beta, double *C, int ldc) {
+        // The (l, j) element of op(B) is B[l * brow + j * bcol].
+        int brow = transb == NoTrans ? 1 : ldb;
+        int bcol = transb == NoTrans ? ldb : 1;
+        for (int j = 0; j < n; ++j) {
+          double *c = C + j * ldc;
+          scale(m, beta, c, 1);
+          if (alpha == 0.0) continue;
+          if (transa == NoTrans) {
+            for (int l = 0; l < k; ++l) {
+              axpy(m, alpha * B[l * brow + j * bcol], A + l * lda, c, 1);
+            }
+          } else {
+            for (int i = 0; i < m; ++i) {
+              c[i] += alpha * small_ddot(
+                  k, A + i * lda, 1, B + j * bcol, brow);
+            }
+          }
+        }
+      }
+
+      // C = alpha * A * A^T + beta * C (trans == NoTrans, A is n x k)
+      // or C = alpha * A^T * A + beta * C (trans == Trans, A is k x n).
+      // Only the 'uplo' triangle of C is referenced.
+      void small_dsyrk(UPLO uplo, TRANSPOSE trans, int n, int k,
+                       double alpha, const double *A, int lda,
+                       double beta, double *C, int ldc) {
+        for (int j = 0; j < n; ++j) {
+          int begin = uplo == Upper ? 0 : j;
+          int end = uplo == Upper ? j + 1 : n;
+          double *c = C + j * ldc;
+          scale(end - begin, beta, c + begin, 1);
+          if (alpha == 0.0) continue;
+          if (trans == NoTrans) {
+            for (int l = 0; l < k; ++l) {
+              axpy(end - begin, alpha * A[j + l * lda],
+                   A + begin + l * lda, c + begin, 1);
+            }
+          } else {
+            for (int i = begin; i < end; ++i) {
+              c[i] += alpha * small_ddot(k, A + i * lda, 1, A + j * lda, 1);
+            }
+          }
+        }
+      }
+
+      // 'work' is the number of multiply-adds in the problem, computed
+      // in long arithmetic so large problems cannot overflow.
+      bool use_small_kernel(long work, int threshold) {
+        return work < threshold;
+      }
+    }  // namespace
+
     double ddot(const int N,
                 const double *X,
                 const int incX,
                 const double *Y,
                 const int incY) {
+      if (use_small_kernel(N, thresholds.ddot) && incX > 0 && incY > 0) {
+        return small_ddot(N, X, incX, Y, incY);
+      }
       return ddot_(&N, X, &incX, Y, &incY);
     }
 
@@ -275,6 +409,11 @@ namespace BOOM {
                const double beta,
                double *Y,
                const int incY) {
+      if (use_small_kernel(long(M) * N, thresholds.dgemv)
+          && incX > 0 && incY > 0) {
+        small_dgemv(TransA, M, N, alpha, A, lda, X, incX, beta, Y, incY);
+        return;
+      }
       dgemv_(TransposeChar[TransA], &M, &N, &alpha, A, &lda,
              X, &incX, &beta, Y, &incY);
     }
@@ -365,6 +504,11 @@ namespace BOOM {
                const double beta,
                double *C,
                const int ldc) {
+      if (use_small_kernel(long(M) * N * K, thresholds.dgemm)) {
+        small_dgemm(TransA, TransB, M, N, K, alpha, A, lda, B, ldb,
+                    beta, C, ldc);
+        return;
+      }
       dgemm_(TransposeChar[TransA], TransposeChar[TransB],
              &M, &N, &K, &alpha, A, &lda, B, &ldb, &beta, C, &ldc);
     }
@@ -395,6 +539,10 @@ namespace BOOM {
                const double beta,
                double *C,
                const int ldc) {
+      if (use_small_kernel(long(N) * (N + 1) * K / 2, thresholds.dsyrk)) {
+        small_dsyrk(Uplo, Trans, N, K, alpha, A, lda, beta, C, ldc);
+        return;
+      }
       dsyrk_(UploChar[Uplo], TransposeChar[Trans],
              &N, &K, &alpha, A, &lda, &beta, C, &ldc);
     }
@@ -527,5 +675,114 @@ namespace BOOM {
            1);
     }
 
+    //======================================================================
+    SmallKernelThresholds small_kernel_thresholds() {
+      return thresholds;
+    }
+
+    void set_small_kernel_thresholds(const SmallKernelThresholds &t) {
+      thresholds = t;
+    }
+
+    namespace {
+      // Seconds per call of f, timed over enough calls to take about a
+      // millisecond.
+      template <class F>
+      double seconds_per_call(F f) {
+        typedef std::chrono::steady_clock clock;
+        for (long reps = 16; ; reps *= 2) {
+          clock::time_point start = clock::now();
+          for (long i = 0; i < reps; ++i) f();
+          double elapsed = std::chrono::duration<double>(
+              clock::now() - start).count();
+          if (elapsed > 1e-3 || reps > (1L << 30)) return elapsed / reps;
+        }
+      }
+
+      // Returns the smallest dimension in 'sizes' at which the BLAS is
+      // at least as fast as the small kernel, or twice the largest
+      // size if there is no such dimension.  'small' and 'reference'
+      // take the dimension as an argument.
+      template <class SMALL, class BLAS>
+      int crossover(const std::vector<int> &sizes,
+                    SMALL small,
+                    BLAS reference) {
+        for (int n : sizes) {
+          double small_time = seconds_per_call([&]() {small(n);});
+          double blas_time = seconds_per_call([&]() {reference(n);});
+          if (blas_time <= small_time) return n;
+        }
+        return 2 * sizes.back();
+      }
+    }  // namespace
+
+    SmallKernelThresholds calibrate_small_kernel_thresholds() {
+      const int max_dim = 256;
+      std::vector<double> a(max_dim * max_dim, 0.5);
+      std::vector<double> b(max_dim * max_dim, 0.25);
+      std::vector<double> c(max_dim * max_dim, 0.0);
+      // The result of each call is written here so the calls cannot
+      // be optimized away.
+      volatile double sink = 0;
+      int one = 1;
+      double alpha = 1.0;
+      double beta = 0.0;
+
+      std::vector<int> sizes;
+      for (int d = 2; d <= max_dim; d *= 2) sizes.push_back(d);
+      SmallKernelThresholds ans;
+      int dim = crossover(
+          sizes,
+          [&](int n) {sink = small_ddot(n, a.data(), 1, b.data(), 1);},
+          [&](int n) {sink = ddot_(&n, a.data(), &one, b.data(), &one);});
+      ans.ddot = dim;
+
+      // Matrix problems use square matrices of dimension 2, 3, 4, 6,
+      // ..., 64.
+      sizes.clear();
+      for (int d = 2; d <= 64; d *= 2) {
+        sizes.push_back(d);
+        if (d < 64) sizes.push_back(d + d / 2);
+      }
+      dim = crossover(
+          sizes,
+          [&](int n) {
+            small_dgemv(NoTrans, n, n, 1.0, a.data(), n, b.data(), 1,
+                        0.0, c.data(), 1);
+            sink = c[0];},
+          [&](int n) {
+            dgemv_("N", &n, &n, &alpha, a.data(), &n, b.data(), &one,
+                   &beta, c.data(), &one);
+            sink = c[0];});
+      ans.dgemv = dim * dim;
+
+      dim = crossover(
+          sizes,
+          [&](int n) {
+            small_dgemm(NoTrans, NoTrans, n, n, n, 1.0, a.data(), n,
+                        b.data(), n, 0.0, c.data(), n);
+            sink = c[0];},
+          [&](int n) {
+            dgemm_("N", "N", &n, &n, &n, &alpha, a.data(), &n,
+                   b.data(), &n, &beta, c.data(), &n);
+            sink = c[0];});
+      ans.dgemm = dim * dim * dim;
+
+      dim = crossover(
+          sizes,
+          [&](int n) {
+            small_dsyrk(Upper, Trans, n, n, 1.0, a.data(), n,
+                        0.0, c.data(), n);
+            sink = c[0];},
+          [&](int n) {
+            dsyrk_("U", "T", &n, &n, &alpha, a.data(), &n,
+                   &beta, c.data(), &n);
+            sink = c[0];});
+      ans.dsyrk = dim * (dim + 1) * dim / 2;
+
+      set_small_kernel_thresholds(ans);
+      return ans;
+    }
+
   }  // namespace blas
 }  // namespace BOOM
@@ -0,0 +1,352 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <Models/Bart/TreeDrawCodec.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <sstream>
+
+#include <cpputil/report_error.hpp>
+
+namespace BOOM {
+  namespace Bart {
+    namespace {
+      const char kMagic[] = "BOOMBART";
+      const int kMagicSize = 8;
+      const unsigned long kFormatVersion = 1;
+
+      //----------------------------------------------------------------------
+      // Encoding primitives.
+      void put_varint(unsigned long value, std::string *out) {
+        while (value >= 0x80) {
+          out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+          value >>= 7;
+        }
+        out->push_back(static_cast<char>(value));
+      }
+
+      void put_double(double value, std::string *out) {
+        unsigned long long bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int i = 0; i < 8; ++i) {
+          out->push_back(static_cast<char>(bits & 0xff));
+          bits >>= 8;
+        }
+      }
+
+      //----------------------------------------------------------------------
+      // Decoding primitives.  Each advances *pos past the decoded
+      // value, and throws if the value would run past 'end'.
+      unsigned long get_varint(const unsigned char **pos,
+                               const unsigned char *end) {
+        unsigned long ans = 0;
+        int shift = 0;
+        while (true) {
+          if (*pos >= end || shift > 63) {
+            report_error("Corrupt or truncated BART tree draw stream.");
+          }
+          unsigned char byte = **pos;
+          ++*pos;
+          ans |= static_cast<unsigned long>(byte & 0x7f) << shift;
+          if (!(byte & 0x80)) return ans;
+          shift += 7;
+        }
+      }
+
+      double get_double(const unsigned char **pos,
+                        const unsigned char *end) {
+        if (end - *pos < 8) {
+          report_error("Corrupt or truncated BART tree draw stream.");
+        }
+        unsigned long long bits = 0;
+        for (int i = 7; i >= 0; --i) {
+          bits = (bits << 8) | (*pos)[i];
+        }
+        *pos += 8;
+        double ans;
+        std::memcpy(&ans, &bits, sizeof(ans));
+        return ans;
+      }
+
+      //----------------------------------------------------------------------
+      // Returns true if the data in a serialized variable summary are
+      // the sorted set of legal cutpoints for the variable.  This
+      // mirrors the logic in VariableSummary::deserialize.
+      bool has_cutpoint_bins(const SerializedVariableSummary &summary) {
+        return summary.finalized &&
+            (!summary.is_continuous || summary.strategy == UNIFORM_DISCRETE);
+      }
+
+      // Advance *pos past one complete subtree (a node and all its
+      // descendants).
+      void skip_subtree(const unsigned char **pos, const unsigned char *end) {
+        int pending = 1;
+        while (pending > 0) {
+          --pending;
+          unsigned long tag = get_varint(pos, end);
+          if (tag == 0) {
+            get_double(pos, end);
+          } else {
+            if (get_varint(pos, end) == 0) {
+              get_double(pos, end);
+            }
+            pending += 2;
+          }
+        }
+      }
+    }  // namespace
+
+    //======================================================================
+    TreeDrawWriter::TreeDrawWriter(
+        std::ostream &out,
+        const std::vector<SerializedVariableSummary> &variable_summaries)
+        : out_(out),
+          variable_summaries_(variable_summaries),
+          number_of_draws_(0)
+    {
+      std::string header(kMagic, kMagicSize);
+      put_varint(kFormatVersion, &header);
+      put_varint(variable_summaries_.size(), &header);
+      for (int i = 0; i < variable_summaries_.size(); ++i) {
+        const SerializedVariableSummary &summary(variable_summaries_[i]);
+        put_varint((summary.finalized ? 1 : 0)
+                   | (summary.is_continuous ? 2 : 0), &header);
+        put_varint(summary.variable_number, &header);
+        put_varint(summary.strategy, &header);
+        put_varint(summary.data.size(), &header);
+        for (int j = 0; j < summary.data.size(); ++j) {
+          put_double(summary.data[j], &header);
+        }
+      }
+      out_.write(header.data(), header.size());
+    }
+
+    //----------------------------------------------------------------------
+    void TreeDrawWriter::write_draw(const BartModelBase &model) {
+      std::string draw;
+      put_varint(model.number_of_trees(), &draw);
+      for (int t = 0; t < model.number_of_trees(); ++t) {
+        Matrix nodes = model.tree(t)->to_matrix();
+        tree_buffer_.clear();
+        put_varint(nodes.nrow(), &tree_buffer_);
+        for (int i = 0; i < nodes.nrow(); ++i) {
+          int variable = lround(nodes(i, 1));
+          if (variable < 0) {
+            put_varint(0, &tree_buffer_);
+            put_double(nodes(i, 2), &tree_buffer_);
+            continue;
+          }
+          put_varint(variable + 1, &tree_buffer_);
+          double cutpoint = nodes(i, 2);
+          if (variable < variable_summaries_.size()
+              && has_cutpoint_bins(variable_summaries_[variable])) {
+            const Vector &bins(variable_summaries_[variable].data);
+            Vector::const_iterator it =
+                std::lower_bound(bins.begin(), bins.end(), cutpoint);
+            if (it != bins.end() && *it == cutpoint) {
+              put_varint(1 + (it - bins.begin()), &tree_buffer_);
+              continue;
+            }
+          }
+          put_varint(0, &tree_buffer_);
+          put_double(cutpoint, &tree_buffer_);
+        }
+        put_varint(tree_buffer_.size(), &draw);
+        draw.append(tree_buffer_);
+      }
+      out_.write(draw.data(), draw.size());
+      ++number_of_draws_;
+    }
+
+    //======================================================================
+    TreeDrawReader::TreeDrawReader(const char *data, std::size_t size)
+        : begin_(reinterpret_cast<const unsigned char *>(data)),
+          end_(begin_ + size)
+    {
+      if (size < kMagicSize || std::memcmp(data, kMagic, kMagicSize) != 0) {
+        report_error("Data is not a BART tree draw stream.");
+      }
+      const unsigned char *pos = begin_ + kMagicSize;
+      unsigned long version = get_varint(&pos, end_);
+      if (version != kFormatVersion) {
+        std::ostringstream err;
+        err << "Unsupported BART tree draw format version " << version
+            << ".  This library reads version " << kFormatVersion << ".";
+        report_error(err.str());
+      }
+      unsigned long number_of_variables = get_varint(&pos, end_);
+      variable_summaries_.resize(number_of_variables);
+      for (int i = 0; i < number_of_variables; ++i) {
+        SerializedVariableSummary &summary(variable_summaries_[i]);
+        unsigned long flags = get_varint(&pos, end_);
+        summary.finalized = flags & 1;
+        summary.is_continuous = flags & 2;
+        summary.variable_number = get_varint(&pos, end_);
+        summary.strategy =
+            static_cast<ContinuousCutpointStrategy>(get_varint(&pos, end_));
+        unsigned long data_size = get_varint(&pos, end_);
+        summary.data.resize(data_size);
+        for (int j = 0; j < data_size; ++j) {
+          summary.data[j] = get_double(&pos, end_);
+        }
+      }
+
+      // Index the draws.  Only the length prefixes are read.
+      while (pos < end_) {
+        draw_offsets_.push_back(pos - begin_);
+        unsigned long number_of_trees = get_varint(&pos, end_);
+        for (int t = 0; t < number_of_trees; ++t) {
+          unsigned long tree_size = get_varint(&pos, end_);
+          if (tree_size > end_ - pos) {
+            report_error("Corrupt or truncated BART tree draw stream.");
+          }
+          pos += tree_size;
+        }
+      }
+    }
+
+    //----------------------------------------------------------------------
+    void TreeDrawReader::check_draw(int draw) const {
+      if (draw < 0 || draw >= draw_offsets_.size()) {
+        std::ostringstream err;
+        err << "Draw " << draw << " requested from a BART tree draw stream "
+            << "containing " << draw_offsets_.size() << " draws.";
+        report_error(err.str());
+      }
+    }
+
+    //----------------------------------------------------------------------
+    int TreeDrawReader::number_of_trees(int draw) const {
+      check_draw(draw);
+      const unsigned char *pos = begin_ + draw_offsets_[draw];
+      return get_varint(&pos, end_);
+    }
+
+    //----------------------------------------------------------------------
+    const unsigned char * TreeDrawReader::tree_position(
+        int draw, int which_tree) const {
+      check_draw(draw);
+      const unsigned char *pos = begin_ + draw_offsets_[draw];
+      int number_of_trees = get_varint(&pos, end_);
+      if (which_tree < 0 || which_tree >= number_of_trees) {
+        std::ostringstream err;
+        err << "Tree " << which_tree << " requested from a draw with "
+            << number_of_trees << " trees.";
+        report_error(err.str());
+      }
+      for (int t = 0; t < which_tree; ++t) {
+        pos += get_varint(&pos, end_);
+      }
+      get_varint(&pos, end_);
+      return pos;
+    }
+
+    //----------------------------------------------------------------------
+    double TreeDrawReader::bin_value(int variable, unsigned long bin) const {
+      if (variable >= variable_summaries_.size()
+          || bin >= variable_summaries_[variable].data.size()) {
+        report_error("Cutpoint bin out of range in BART tree draw stream.");
+      }
+      return variable_summaries_[variable].data[bin];
+    }
+
+    //----------------------------------------------------------------------
+    Matrix TreeDrawReader::tree_matrix(int draw, int which_tree) const {
+      const unsigned char *pos = tree_position(draw, which_tree);
+      int number_of_nodes = get_varint(&pos, end_);
+      Matrix ans(number_of_nodes, 3);
+      // Interior nodes still waiting for a child, paired with the
+      // number of children they have received so far.
+      std::vector<std::pair<int, int> > open_nodes;
+      for (int id = 0; id < number_of_nodes; ++id) {
+        int parent_id = -1;
+        if (!open_nodes.empty()) {
+          parent_id = open_nodes.back().first;
+          if (++open_nodes.back().second == 2) {
+            open_nodes.pop_back();
+          }
+        }
+        ans(id, 0) = parent_id;
+        unsigned long tag = get_varint(&pos, end_);
+        if (tag == 0) {
+          ans(id, 1) = -1;
+          ans(id, 2) = get_double(&pos, end_);
+        } else {
+          int variable = tag - 1;
+          ans(id, 1) = variable;
+          unsigned long code = get_varint(&pos, end_);
+          ans(id, 2) = code == 0 ? get_double(&pos, end_)
+              : bin_value(variable, code - 1);
+          open_nodes.push_back(std::make_pair(id, 0));
+        }
+      }
+      return ans;
+    }
+
+    //----------------------------------------------------------------------
+    Tree TreeDrawReader::tree(int draw, int which_tree) const {
+      return Tree(tree_matrix(draw, which_tree));
+    }
+
+    //----------------------------------------------------------------------
+    void TreeDrawReader::restore_draw(int draw,
+                                      BartModelBase *model) const {
+      int number_of_trees = this->number_of_trees(draw);
+      model->set_number_of_trees(number_of_trees);
+      for (int t = 0; t < number_of_trees; ++t) {
+        Matrix nodes = tree_matrix(draw, t);
+        model->rebuild_tree(t, ConstSubMatrix(nodes));
+      }
+    }
+
+    //----------------------------------------------------------------------
+    double TreeDrawReader::predict(int draw, const ConstVectorView &x) const {
+      check_draw(draw);
+      const unsigned char *pos = begin_ + draw_offsets_[draw];
+      int number_of_trees = get_varint(&pos, end_);
+      double ans = 0;
+      for (int t = 0; t < number_of_trees; ++t) {
+        unsigned long tree_size = get_varint(&pos, end_);
+        const unsigned char *next_tree = pos + tree_size;
+        const unsigned char *node = pos;
+        get_varint(&node, end_);  // number of nodes
+        while (true) {
+          unsigned long tag = get_varint(&node, end_);
+          if (tag == 0) {
+            ans += get_double(&node, end_);
+            break;
+          }
+          int variable = tag - 1;
+          unsigned long code = get_varint(&node, end_);
+          double cutpoint = code == 0 ? get_double(&node, end_)
+              : bin_value(variable, code - 1);
+          // The left child immediately follows its parent.  The right
+          // child follows the left child's subtree.
+          if (x[variable] > cutpoint) {
+            skip_subtree(&node, end_);
+          }
+        }
+        pos = next_tree;
+      }
+      return ans;
+    }
+
+  }  // namespace Bart
+}  // namespace BOOM
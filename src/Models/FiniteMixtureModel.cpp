@@ -107,10 +107,10 @@ namespace BOOM{
           wsp_[s] = logpi_[s] + mod[s]->pdf(dp.get(), true);
         }
       }
-      last_loglike_ += lse(wsp_);
-      wsp_.normalize_logprob();
+      double log_normalizing_constant;
+      uint h = rmulti_logprob_mt(rng, wsp_, &log_normalizing_constant);
+      last_loglike_ += log_normalizing_constant;
       class_membership_probabilities_.row(i) = wsp_;
-      uint h = rmulti_mt(rng, wsp_);
       cd->set(h);
       mod[h]->add_data(dp);
       mix->add_data(cd);
@@ -279,11 +279,8 @@ namespace BOOM{
       }
       double total = lse(wsp);
       ans += total;
-      double normalizing_constant = 0;
-      for(int s = 0; s < number_of_mixture_components(); ++s){
-        wsp[s] = exp(wsp[s] - total);
-        normalizing_constant += wsp[s];
-      }
+      double normalizing_constant =
+          exp_shifted(wsp.data(), total, wsp.data(), wsp.size());
       for(int s = 0; s < number_of_mixture_components(); ++s){
         em_mixture_components_[s]->add_mixture_data(
             data[i], wsp[s] / normalizing_constant);
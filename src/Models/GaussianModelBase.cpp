@@ -17,6 +17,7 @@
 */
 #include <Models/GaussianModelBase.hpp>
 #include <distributions.hpp>
+#include <cpputil/Constants.hpp>
 #include <Models/SufstatAbstractCombineImpl.hpp>
 
 namespace BOOM{
@@ -157,6 +158,24 @@ namespace BOOM{
     return logscale ? ans : exp(ans);
   }
 
+  void GaussianModelBase::fill_logp(const std::vector<Ptr<Data> > &data,
+                                    int start,
+                                    VectorView ans)const{
+    double mean = mu();
+    double sd = sigma();
+    double normalizing_constant = -log(sd) - Constants::log_root_2pi;
+    double precision = 1.0 / (sd * sd);
+    for(int i = 0; i < ans.size(); ++i){
+      const Data *dp = data[start + i].get();
+      if(dp->missing()){
+        ans[i] = 0;
+      }else{
+        double z = DAT(dp)->value() - mean;
+        ans[i] = normalizing_constant - .5 * z * z * precision;
+      }
+    }
+  }
+
   double GaussianModelBase::Logp(double x, double &g, double &h, uint nd)const{
     double m = mu();
     double ans = dnorm(x, m, sigma(), 1);
@@ -351,7 +351,7 @@ namespace BOOM{
 
   Vector & MLM::predict(Ptr<ChoiceData> dp, Vector &ans) const {
     fill_eta(*dp, ans);
-    ans = exp(ans-lse(ans));
+    ans.normalize_logprob();
     return ans;
   }
 
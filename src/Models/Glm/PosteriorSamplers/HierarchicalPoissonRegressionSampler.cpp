@@ -18,6 +18,7 @@
 
 #include <Models/Glm/PosteriorSamplers/HierarchicalPoissonRegressionSampler.hpp>
 #include <distributions.hpp>
+#include <sstream>
 
 namespace {
   //  Some global constants that can be used to control the sub-steps
@@ -83,21 +84,60 @@ namespace BOOM {
   void HPRS::impute_latent_data() {
     MvnModel * data_parent_model = model_->data_parent_model();
     data_parent_model->clear_data();
-    for (int i = 0; i < data_model_samplers_.size(); ++i) {
-      if (draw_beta) {
-        //        cerr << "drawing beta" << endl;
-        data_model_samplers_[i]->draw();
-      } else {
+    if (draw_beta) {
+      draw_group_coefficients();
+    } else {
+      for (int i = 0; i < data_model_samplers_.size(); ++i) {
         //        cerr << "drawing latent data, but not changing beta" << endl;
         const Vector beta = model_->data_model(i)->Beta();
         data_model_samplers_[i]->draw();
         model_->data_model(i)->set_Beta(beta);
       }
+    }
+    for (int i = 0; i < data_model_samplers_.size(); ++i) {
       Ptr<VectorData> beta = model_->data_model(i)->coef_prm();
       data_parent_model->add_data(beta);
     }
   }
 
+  // Each group's coefficients have the same prior, so the draw for
+  // group i is the one data_model_samplers_[i]->draw() would make,
+  // with the noise taken from that sampler's RNG.  The small
+  // factorizations are done as a batch, rather than one Chol per
+  // group.
+  void HPRS::draw_group_coefficients() {
+    int ngroups = data_model_samplers_.size();
+    int xdim = model_->xdim();
+    if (group_coefficients_.size() != ngroups
+        || group_coefficients_.dim() != xdim) {
+      group_coefficients_.resize(xdim, ngroups);
+      group_coefficients_.set_number_of_threads(nthreads_);
+    }
+    const MvnModel *prior = model_->data_parent_model();
+    const SpdMatrix &prior_precision(prior->siginv());
+    Vector prior_shift = prior_precision * prior->mu();
+    for (int i = 0; i < ngroups; ++i) {
+      PoissonRegressionAuxMixSampler *sampler = data_model_samplers_[i].get();
+      sampler->impute_latent_data();
+      const WeightedRegSuf &suf(
+          sampler->complete_data_sufficient_statistics());
+      group_coefficients_.set_system(
+          i, prior_precision + suf.xtx(), prior_shift + suf.xty());
+      group_coefficients_.simulate_noise(i, sampler->rng());
+    }
+    group_coefficients_.draw();
+    for (int i = 0; i < ngroups; ++i) {
+      if (!group_coefficients_.positive_definite(i)) {
+        std::ostringstream err;
+        err << "The posterior precision of the coefficients for group " << i
+            << " is not positive definite in "
+            << "HierarchicalPoissonRegressionPosteriorSampler.";
+        report_error(err.str());
+      }
+      model_->data_model(i)->set_Beta(group_coefficients_.solution(i));
+    }
+  }
+
   void HPRS::compute_zero_mean_sufficient_statistics() {
     zero_mean_random_effect_model_->clear_data();
     Vector mu(model_->data_parent_model()->mu());
@@ -75,8 +75,7 @@ namespace BOOM{
     for(uint k=0; k<K; ++k)
       post_prob_[k] = log_mixing_weights_[k] +
           dnorm(u, mu_[k], sd_[k], true);
-    post_prob_.normalize_logprob();
-    return rmulti_mt(rng, post_prob_);
+    return rmulti_logprob_mt(rng, post_prob_);
   }
 
 } // namespace BOOM
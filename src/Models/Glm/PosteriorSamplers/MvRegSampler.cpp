@@ -17,6 +17,8 @@
 */
 #include <Models/Glm/PosteriorSamplers/MvRegSampler.hpp>
 #include <distributions.hpp>
+#include <LinAlg/Cholesky.hpp>
+#include <LinAlg/Kronecker.hpp>
 
 namespace BOOM{
 
@@ -54,10 +56,12 @@ namespace BOOM{
     Ptr<NeMvRegSuf> s(mod->suf().dcast<NeMvRegSuf>());
 
     SpdMatrix ivar = Ominv + s->xtx();
-    Matrix Mu = s->xty() + Ominv*B;
-    Mu = ivar.solve(Mu);
-    Matrix ans = rmatrix_normal_ivar(Mu, mod->Siginv(), ivar);
-    mod->set_Beta(ans);
+    // One factorization of ivar serves both the posterior mean and the
+    // draw.
+    Chol ivar_chol(ivar);
+    Matrix Mu = ivar_chol.solve(s->xty() + Ominv*B);
+    SpdKroneckerProduct precision(Chol(mod->Siginv()), ivar_chol);
+    mod->set_Beta(precision.rmvn_ivar(rng(), Mu));
   }
 
   void MRS::draw_Sigma(){
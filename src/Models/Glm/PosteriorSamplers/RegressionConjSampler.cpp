@@ -18,6 +18,8 @@
 
 #include <Models/Glm/PosteriorSamplers/RegressionConjSampler.hpp>
 #include <distributions.hpp>
+#include <cpputil/report_error.hpp>
+#include <cmath>
 
 
 namespace BOOM{
@@ -47,7 +49,11 @@ namespace BOOM{
 
     beta_tilde = m_->xty() + Ominv * b0;
     ivar= Ominv + m_->xtx();
-    beta_tilde = ivar.solve(beta_tilde);
+    if(!ivar_chol.decompose(ivar)){
+      report_error("Posterior precision matrix is not positive definite "
+                   "in RegressionConjSampler.");
+    }
+    ivar_chol.solve_inplace(beta_tilde);
 
     SS = prior_ss() + m_->yty() + Ominv.Mdist(b0);
     SS -= ivar.Mdist(beta_tilde);
@@ -61,7 +67,9 @@ namespace BOOM{
         DF - prior_df(),
         SS - prior_ss());
     ivar /= sigsq;
-    beta_tilde = rmvn_ivar(beta_tilde, ivar);
+    // The Cholesky factor of ivar / sigsq is L / sqrt(sigsq).
+    ivar_chol *= 1.0 / std::sqrt(sigsq);
+    beta_tilde = rmvn_ivar_L_mt(rng(), beta_tilde, ivar_chol);
     m_->set_Beta(beta_tilde);
     m_->set_sigsq(sigsq);
   }
@@ -2,6 +2,8 @@
 #include <distributions.hpp>
 #include <cpputil/seq.hpp>
 #include <cpputil/math_utils.hpp>
+#include <cpputil/report_error.hpp>
+#include <LinAlg/Cholesky.hpp>
 
 namespace BOOM {
 
@@ -74,8 +76,15 @@ namespace BOOM {
         inclusion_indicators.select(slab_prior_->mu());
     precision += inclusion_indicators.select(suf.xtx()) / sigsq;
     precision_mu += inclusion_indicators.select(suf.xty()) / sigsq;
-    Vector coefficients = precision.solve(precision_mu);
-    coefficients = rmvn_ivar_mt(rng, coefficients, precision);
+    // Factor the posterior precision once, for both the posterior
+    // mean and the draw.
+    Chol precision_cholesky(precision);
+    if (!precision_cholesky.is_pos_def()) {
+      report_error("Posterior precision matrix is not positive definite "
+                   "in SpikeSlabSampler::draw_beta.");
+    }
+    Vector coefficients = precision_cholesky.solve(precision_mu);
+    coefficients = rmvn_ivar_L_mt(rng, coefficients, precision_cholesky);
 
     // If model selection is turned off and some elements of beta
     // happen to be zero (because, e.inclusion_indicators., of a
@@ -0,0 +1,114 @@
+#include <Models/HMM/Clickstream/EventLog.hpp>
+
+#include <istream>
+#include <sstream>
+#include <string>
+#include <cpputil/report_error.hpp>
+
+namespace BOOM {
+  namespace Clickstream{
+
+    EventLog::EventLog(int number_of_event_types)
+        : number_of_event_types_(number_of_event_types),
+          session_start_(1, 0),
+          stream_start_(1, 0)
+    {
+      if (number_of_event_types_ < 2) {
+        report_error("An EventLog needs at least one event type "
+                     "in addition to EOS.");
+      }
+    }
+
+    //----------------------------------------------------------------------
+    void EventLog::clear() {
+      events_.clear();
+      session_start_.assign(1, 0);
+      stream_start_.assign(1, 0);
+      stream_ids_.clear();
+    }
+
+    //----------------------------------------------------------------------
+    void EventLog::start_stream(long stream_id) {
+      stream_ids_.push_back(stream_id);
+      stream_start_.push_back(stream_start_.back());
+    }
+
+    //----------------------------------------------------------------------
+    void EventLog::add_session(const std::vector<int> &events) {
+      if (stream_ids_.empty()) {
+        report_error("Call EventLog::start_stream before adding sessions.");
+      }
+      if (events.empty()) {
+        report_error("Empty session passed to EventLog::add_session.");
+      }
+      int n = events.size();
+      for (int i = 0; i < n; ++i) {
+        int y = events[i];
+        if (y < 0 || y >= number_of_event_types_) {
+          std::ostringstream err;
+          err << "Event type " << y << " is out of range in "
+              << "EventLog::add_session.  There are "
+              << number_of_event_types_ << " event types, including EOS.";
+          report_error(err.str());
+        }
+        if (y == eos() && i + 1 < n) {
+          std::ostringstream err;
+          err << "Non-terminal session element " << i << " is EOS.";
+          report_error(err.str());
+        }
+      }
+      events_.insert(events_.end(), events.begin(), events.end());
+      if (events.back() != eos()) {
+        events_.push_back(eos());
+      }
+      session_start_.push_back(events_.size());
+      ++stream_start_.back();
+    }
+
+    //----------------------------------------------------------------------
+    int EventLog::read(std::istream &in, int max_sessions) {
+      int sessions_read = 0;
+      std::string line;
+      std::vector<int> session;
+      while ((max_sessions < 0 || sessions_read < max_sessions)
+             && std::getline(in, line)) {
+        std::istringstream fields(line);
+        long id;
+        if (!(fields >> id)) continue;  // skip blank lines
+        session.clear();
+        int y;
+        while (fields >> y) session.push_back(y);
+        if (!fields.eof()) {
+          std::ostringstream err;
+          err << "Could not parse the line '" << line
+              << "' in EventLog::read.";
+          report_error(err.str());
+        }
+        if (stream_ids_.empty() || stream_ids_.back() != id) {
+          start_stream(id);
+        }
+        add_session(session);
+        ++sessions_read;
+      }
+      return sessions_read;
+    }
+
+    //----------------------------------------------------------------------
+    Ptr<Stream> EventLog::materialize(int stream, Ptr<CatKey> key)const {
+      std::vector<Ptr<Session> > sessions;
+      for (int s = first_session(stream); s < end_session(stream); ++s) {
+        std::vector<Ptr<Event> > events;
+        for (const int *y = session_begin(s); y != session_end(s); ++y) {
+          if (events.empty()) {
+            events.push_back(new Event(*y, key));
+          } else {
+            events.push_back(new Event(*y, events.back()));
+          }
+        }
+        sessions.push_back(new Session(events, false));
+      }
+      return new Stream(sessions);
+    }
+
+  }  // namespace Clickstream
+}  // namespace BOOM
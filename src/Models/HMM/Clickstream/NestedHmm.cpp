@@ -7,6 +7,7 @@
 #include <Models/HMM/hmm_tools.hpp>
 #include <distributions.hpp>
 #include <distributions/Markov.hpp>
+#include <cpputil/math_utils.hpp>
 
 #ifndef NO_BOOST_THREADS
 #include <boost/thread.hpp>
@@ -44,8 +45,8 @@ namespace BOOM {
         logpi0_(S1 * S2),
         logd_(S1 * S2),
         one_(S1 * S2, 1.0),
-        logQ1_(S1 * S2, S1 * S2),
-        logQ2_(S1 * S2, S1 * S2)
+        Q1_(S1 * S2, S1 * S2),
+        Q2_(S1 * S2, S1 * S2)
   {
     setup();
   }
@@ -62,8 +63,8 @@ namespace BOOM {
         logpi0_(S1 * S2),
         logd_(S1 * S2),
         one_(S1 * S2, 1.0),
-        logQ1_(S1 * S2, S1 * S2),
-        logQ2_(S1 * S2, S1 * S2)
+        Q1_(S1 * S2, S1 * S2),
+        Q2_(S1 * S2, S1 * S2)
       {
         setup();
       }
@@ -89,6 +90,13 @@ namespace BOOM {
   //----------------------------------------------------------------------
   double NestedHmm::initialize(Ptr<Event> dp)const{
     fill_logd(dp);
+    return initialize_filter();
+  }
+  //----------------------------------------------------------------------
+  // Sets pi_ to the distribution of the first hidden state given the
+  // first event, whose log densities have already been placed in
+  // logd_.
+  double NestedHmm::initialize_filter()const{
     pi_ = logpi0_ + logd_;
     double M = max(pi_);
     pi_-=M;
@@ -192,10 +200,10 @@ namespace BOOM {
           }
         }else{
           fill_logd(event);
-          // use logQ1_ if the first event in a session.
-          // use logQ2_ otherwise
-          const Matrix & logQ(j == 0 ? logQ1_ : logQ2_);
-          ans+= fwd_1(pi_, P[event_num], logQ, logd_, one_);
+          // use Q1_ if the first event in a session.
+          // use Q2_ otherwise
+          const Matrix & Q(j == 0 ? Q1_ : Q2_);
+          ans+= fwd_1_scaled(pi_, P[event_num], Q, logd_, one_, wsp_);
           if(!std::isfinite(ans)  || !std::isfinite(pi_[0])){
             ostringstream err;
             print_event(err, "found an infinity in NestedHmm::fwd",
@@ -210,6 +218,218 @@ namespace BOOM {
     return ans;
   }
   //----------------------------------------------------------------------
+  std::vector<int> NestedHmm::most_likely_states(Ptr<Stream> u)const{
+    fill_big_Q();
+    Matrix logQ1 = log(Q1_);
+    Matrix logQ2 = log(Q2_);
+    ViterbiRecursion viterbi;
+    int Nsessions = u->nsessions();
+    bool initialized = false;
+    for(int i = 0; i < Nsessions; ++i){
+      Ptr<Session> session = u->session(i);
+      int nevents = session->number_of_events_including_eos();
+      for(int j = 0; j < nevents; ++j){
+        fill_logd(session->event(j));
+        if(!initialized){
+          viterbi.initialize(logpi0_ + logd_);
+          initialized = true;
+        }else{
+          viterbi.update(j == 0 ? logQ1 : logQ2, logd_);
+        }
+      }
+    }
+    if(!initialized) return std::vector<int>();
+    return viterbi.most_likely_path();
+  }
+  //----------------------------------------------------------------------
+  Matrix NestedHmm::state_probabilities(Ptr<Stream> u)const{
+    int n = u->number_of_events_including_eos();
+    int S = S1_ * S2_;
+    Matrix ans(n, S);
+    if(n == 0) return ans;
+    fill_big_Q();
+    fwd(u);
+    Vector pi(pi_);
+    Vector wsp(S);
+    ans.row(n - 1) = pi;
+    for(int t = n - 1; t > 0; --t){
+      bkwd_1(pi, P[t], wsp, one_);
+      ans.row(t - 1) = pi;
+    }
+    return ans;
+  }
+  //----------------------------------------------------------------------
+  double NestedHmm::fwd(const Clickstream::EventLog &log, int stream)const{
+    fill_big_Q();
+    fill_log_emission_table();
+    return fwd(log, stream, NULL);
+  }
+  //----------------------------------------------------------------------
+  // The forward filter for one stream in an EventLog.  If 'history'
+  // is non-NULL it is the filtered distribution of the hidden state
+  // at the last event before the stream, and the first event in the
+  // stream is treated as the first event of a new session following
+  // it.  In that case P[0] holds the joint distribution of the
+  // hidden states on either side of the boundary.
+  double NestedHmm::fwd(const Clickstream::EventLog &log,
+                        int stream,
+                        const Vector *history)const{
+    check_filter_size(log.number_of_events(stream));
+    double ans = 0;
+    int event_num = 0;
+    for(int session = log.first_session(stream);
+        session < log.end_session(stream); ++session){
+      int previous = -1;
+      for(const int *y = log.session_begin(session);
+          y != log.session_end(session); ++y){
+        fill_logd(previous, *y);
+        if(event_num == 0 && !history){
+          ans += initialize_filter();
+        }else{
+          if(event_num == 0) pi_ = *history;
+          const Matrix & Q(previous < 0 ? Q1_ : Q2_);
+          ans += fwd_1_scaled(pi_, P[event_num], Q, logd_, one_, wsp_);
+        }
+        if(!std::isfinite(ans)){
+          ostringstream err;
+          err << "found an infinite value in NestedHmm::fwd at event "
+              << event_num << " of stream " << log.stream_id(stream);
+          report_error(err.str());
+        }
+        previous = *y;
+        ++event_num;
+      }
+    }
+    return ans;
+  }
+  //----------------------------------------------------------------------
+  double NestedHmm::add_sessions(const Clickstream::EventLog &log,
+                                 bool sample){
+    if(log.number_of_event_types() != S0_){
+      ostringstream err;
+      err << "The EventLog passed to NestedHmm::add_sessions has "
+          << log.number_of_event_types() << " event types, but the model "
+          << "expects " << S0_ << "." << endl;
+      report_error(err.str());
+    }
+    fill_big_Q();
+    fill_log_emission_table();
+    double ans = 0;
+    for(int stream = 0; stream < log.number_of_streams(); ++stream){
+      if(log.number_of_events(stream) == 0) continue;
+      Vector &history(stream_filter_state_[log.stream_id(stream)]);
+      bool continuing = !history.empty();
+      ans += fwd(log, stream, continuing ? &history : NULL);
+      // The backward pass overwrites pi_, so save the filter state
+      // first.
+      history = pi_;
+      if(sample){
+        bkwd_sampling(log, stream, continuing);
+      }else{
+        bkwd_smoothing(log, stream, continuing);
+      }
+    }
+    return ans;
+  }
+  //----------------------------------------------------------------------
+  void NestedHmm::clear_stream_history(){
+    stream_filter_state_.clear();
+  }
+  //----------------------------------------------------------------------
+  int NestedHmm::number_of_tracked_streams()const{
+    return stream_filter_state_.size();
+  }
+  //----------------------------------------------------------------------
+  // Mirrors bkwd_sampling(Ptr<Stream>).  If 'continuing' is true the
+  // first event in the stream follows a saved filter state, so the
+  // hidden state before it is drawn from P[0] and recorded as a
+  // session transition rather than an initial value.
+  void NestedHmm::bkwd_sampling(const Clickstream::EventLog &log,
+                                int stream,
+                                bool continuing){
+    int event_num = log.number_of_events(stream);
+    int first = log.first_session(stream);
+    int s = rmulti_mt(rng(), pi_);
+    int Hnow, hnow;
+    decode_state(s, Hnow, hnow);
+
+    for(int session = log.end_session(stream); session != first; --session){
+      const int *begin = log.session_begin(session - 1);
+      for(const int *y = log.session_end(session - 1); y != begin; --y){
+        // y[-1] is the current event.
+        int previous = (y - 1 == begin) ? -1 : y[-2];
+        mix(Hnow, hnow)->suf()->add_mixture_data(previous, y[-1], 1.0);
+        int Hthen = 0;
+        int hthen = 0;
+        --event_num;
+        if(event_num > 0 || continuing){
+          pi_ = P[event_num].col(s);
+          s = rmulti_mt(rng(), pi_);
+          decode_state(s, Hthen, hthen);
+        }
+
+        if(previous < 0){
+          event_model(Hnow)->suf()->add_initial_value(hnow);
+          if(event_num == 0 && !continuing){
+            session_model()->suf()->add_initial_value(Hnow);
+          }else{
+            session_model()->suf()->add_transition(Hthen, Hnow);
+          }
+        }else{
+          event_model(Hnow)->suf()->add_transition(hthen, hnow);
+        }
+        Hnow = Hthen;
+        hnow = hthen;
+      }
+    }
+  }
+  //----------------------------------------------------------------------
+  // Mirrors bkwd_smoothing(Ptr<Stream>), with 'continuing' as in
+  // bkwd_sampling above.
+  void NestedHmm::bkwd_smoothing(const Clickstream::EventLog &log,
+                                 int stream,
+                                 bool continuing){
+    int event_num = log.number_of_events(stream);
+    int first = log.first_session(stream);
+    Vector hinit, Hinit;
+    Matrix htrans, Htrans;
+    Vector wsp(S2_ * S1_);
+
+    for(int session = log.end_session(stream); session != first; --session){
+      const int *begin = log.session_begin(session - 1);
+      for(const int *y = log.session_end(session - 1); y != begin; --y){
+        int previous = (y - 1 == begin) ? -1 : y[-2];
+        --event_num;
+        for(int H = 0; H < S2_; ++H){
+          for(int h = 0; h < S1_; ++h){
+            mix(H, h)->suf()->add_mixture_data(
+                previous, y[-1], pi_[encode_state(H, h)]);
+          }
+        }
+
+        if(previous < 0){
+          for(int H = 0; H < S2_; ++H){
+            hinit = get_hinit(pi_, H);
+            event_model(H)->suf()->add_initial_distribution(hinit);
+          }
+          if(event_num == 0 && !continuing){
+            Hinit = get_Hinit(pi_);
+            session_model()->suf()->add_initial_distribution(Hinit);
+          }else{
+            Htrans = get_Htrans(P[event_num]);
+            session_model()->suf()->add_transition_distribution(Htrans);
+          }
+        }else{
+          for(int H = 0; H < S2_; ++H){
+            htrans = get_htrans(P[event_num], H);
+            event_model(H)->suf()->add_transition_distribution(htrans);
+          }
+        }
+        if(event_num > 0) bkwd_1(pi_, P[event_num], wsp, one_);
+      }
+    }
+  }
+  //----------------------------------------------------------------------
   void NestedHmm::update_mixture(int H, int h, Ptr<Event> event, double p){
     mix(H,h)->suf()->add_mixture_data(event, p);
   }
@@ -488,8 +708,8 @@ namespace BOOM {
         if(event_num > 0){
           assert(i>1 || j>1);
           pi_ = P[event_num].col(s);       // P = joint dist. of yesterday,today
-          int r = rmulti_mt(rng(), pi_);  // pi_  = dist. of yesterday's event
-          decode_state(r, Hthen, hthen);
+          s = rmulti_mt(rng(), pi_);      // pi_  = dist. of yesterday's event
+          decode_state(s, Hthen, hthen);
         }
 
         if (j == 1) {     // start of a new session
@@ -691,14 +911,41 @@ namespace BOOM {
         logd_[i++] = logp(dp, H, h);}}
   }
   //----------------------------------------------------------------------
+  void NestedHmm::fill_logd(int previous_event, int event)const{
+    logd_ = log_emission_.col((previous_event + 1) * S0_ + event);
+  }
+  //----------------------------------------------------------------------
+  void NestedHmm::fill_log_emission_table()const{
+    int S = S1_ * S2_;
+    if(log_emission_.nrow() != S || log_emission_.ncol() != (S0_ + 1) * S0_){
+      log_emission_.resize(S, (S0_ + 1) * S0_);
+    }
+    for(int H = 0; H < S2_; ++H){
+      for(int h = 0; h < S1_; ++h){
+        int state = encode_state(H, h);
+        const Vector &pi0(mix(H, h)->pi0());
+        const Matrix &Q(mix(H, h)->Q());
+        for(int y = 0; y < S0_; ++y){
+          log_emission_(state, y) = safelog(pi0[y]);
+        }
+        for(int previous = 0; previous < S0_; ++previous){
+          for(int y = 0; y < S0_; ++y){
+            log_emission_(state, (previous + 1) * S0_ + y) =
+                safelog(Q(previous, y));
+          }
+        }
+      }
+    }
+  }
+  //----------------------------------------------------------------------
   double NestedHmm::logp(Ptr<Event> event, int H, int h)const{
     return mix(H, h)->pdf(*event, true);
   }
   //----------------------------------------------------------------------
   void NestedHmm::fill_big_Q()const{
     // fills logpi0_ (for first event ever)
-    //       logQ1_  (for transitions to the first event in a new session)
-    //       logQ2_  (for transitions within a session)
+    //       Q1_  (for transitions to the first event in a new session)
+    //       Q2_  (for transitions within a session)
 
     // pi0_ looks like:     phi2[1] * vector( phi1[H=1] )
     //                      phi2[2] * vector( phi1[H=2] )
@@ -719,11 +966,11 @@ namespace BOOM {
     if(logpi0_.size() != S) logpi0_.resize(S);
     if(logd_.size() != S) logd_.resize(S);
 
-    if(logQ1_.nrow() != S || logQ1_.ncol() != S) logQ1_.resize(S,S);
-    logQ1_ = 0;
+    if(Q1_.nrow() != S || Q1_.ncol() != S) Q1_.resize(S,S);
+    Q1_ = 0;
 
-    if(logQ2_.nrow() != S || logQ2_.ncol() != S) logQ2_.resize(S,S);
-    logQ2_ = 0;
+    if(Q2_.nrow() != S || Q2_.ncol() != S) Q2_.resize(S,S);
+    Q2_ = 0;
 
 
     int i = 0;
@@ -743,20 +990,18 @@ namespace BOOM {
       VectorView pi_H(logpi0_, i, S1_);
       pi_H = phi2[H] * event_model(H)->pi0();
 
-      SubMatrix Q2(logQ2_, i, i+S1_ - 1, i, i+S1_ - 1);
+      SubMatrix Q2(Q2_, i, i+S1_ - 1, i, i+S1_ - 1);
       Q2 = event_model(H)->Q();
 
       int j = 0;
       for(int HH = 0; HH < S2_; ++HH){
-        SubMatrix Q1(logQ1_, i, i+S1_ - 1, j, j+S1_ - 1);
+        SubMatrix Q1(Q1_, i, i+S1_ - 1, j, j+S1_ - 1);
         Q1 = Phi2(H,HH) * stacked_phi1[HH];  // scalar times matrix
         j+= S1_;
       }
       i+= S1_;
     }
 
-    logQ1_ = log(logQ1_);
-    logQ2_ = log(logQ2_);
     logpi0_ = log(logpi0_);
   }
   //----------------------------------------------------------------------
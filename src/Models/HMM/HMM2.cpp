@@ -41,6 +41,52 @@ namespace BOOM{
 
   typedef HiddenMarkovModel HMM;
 
+  namespace {
+    // Scores every stride'th series, starting with 'first', using a
+    // private filter so that several scorers can run concurrently.
+    class HmmScorer {
+     public:
+      HmmScorer(Ptr<HmmFilter> filter,
+                const std::vector<Ptr<HMM::DataSeriesType> > &series,
+                int first,
+                int stride,
+                std::vector<std::vector<int> > *paths,
+                std::vector<Matrix> *probs)
+          : filter_(filter),
+            series_(&series),
+            first_(first),
+            stride_(stride),
+            paths_(paths),
+            probs_(probs)
+      {}
+
+      void operator()(){
+        try{
+          for(int i = first_; i < series_->size(); i += stride_){
+            const HMM::DataSeriesType &ts(*(*series_)[i]);
+            if(paths_) (*paths_)[i] = filter_->most_likely_states(ts);
+            if(probs_) (*probs_)[i] = filter_->state_probabilities(ts);
+          }
+        }catch(const std::exception &e){
+          error_message_ = e.what();
+        }catch(...){
+          error_message_ = "Unknown exception while scoring an HMM.";
+        }
+      }
+
+      const std::string &error_message()const{return error_message_;}
+
+     private:
+      Ptr<HmmFilter> filter_;
+      const std::vector<Ptr<HMM::DataSeriesType> > *series_;
+      int first_;
+      int stride_;
+      std::vector<std::vector<int> > *paths_;
+      std::vector<Matrix> *probs_;
+      std::string error_message_;
+    };
+  }  // namespace
+
   //======================================================================
 
   HMM::HiddenMarkovModel(std::vector<Ptr<MixtureComponent> > Mix,
@@ -143,12 +189,9 @@ namespace BOOM{
 
   double HMM::loglike()const{
     uint ns = nseries();
-    double ans=0;
-    for(uint series=0; series < ns; ++series){
-      const DataSeriesType & ts(dat(series));
-      ans += filter_->loglike(ts);
-    }
-    return ans;
+    std::vector<const std::vector<Ptr<Data> > *> series(ns);
+    for(uint i=0; i < ns; ++i) series[i] = &dat(i);
+    return filter_->loglike(series);
   }
 
   void HMM::save_state_probs(){
@@ -171,6 +214,71 @@ namespace BOOM{
     return ans;
   }
 
+  std::vector<int> HMM::most_likely_states(const DataSeriesType &ts)const{
+    return filter_->most_likely_states(ts);
+  }
+
+  Matrix HMM::state_probabilities(const DataSeriesType &ts)const{
+    return filter_->state_probabilities(ts);
+  }
+
+  std::vector<std::vector<int> > HMM::most_likely_states(
+      const std::vector<Ptr<DataSeriesType> > &series, int nthreads)const{
+    std::vector<std::vector<int> > ans(series.size());
+    score_series(series, nthreads, &ans, NULL);
+    return ans;
+  }
+
+  std::vector<Matrix> HMM::state_probabilities(
+      const std::vector<Ptr<DataSeriesType> > &series, int nthreads)const{
+    std::vector<Matrix> ans(series.size());
+    score_series(series, nthreads, NULL, &ans);
+    return ans;
+  }
+
+  void HMM::score_series(const std::vector<Ptr<DataSeriesType> > &series,
+                         int nthreads,
+                         std::vector<std::vector<int> > *paths,
+                         std::vector<Matrix> *probs)const{
+#ifdef NO_BOOST_THREADS
+    nthreads = 1;
+#endif
+    if(nthreads <= 1 || series.size() <= 1){
+      HmmScorer scorer(filter_, series, 0, 1, paths, probs);
+      scorer();
+      if(!scorer.error_message().empty()) report_error(scorer.error_message());
+      return;
+    }
+#ifndef NO_BOOST_THREADS
+    // Each thread gets its own filter, because filters hold the
+    // forward probabilities as state.  The mixture components are
+    // shared, and only their (const) density functions are called.
+    // The first series is scored before any threads start, so any
+    // lazily computed caches in the components are filled in while
+    // there is only one thread.
+    HmmScorer first_series(filter_, series, 0, series.size(), paths, probs);
+    first_series();
+    if(!first_series.error_message().empty()){
+      report_error(first_series.error_message());
+    }
+    std::vector<HmmScorer> scorers;
+    for(int i = 0; i < nthreads; ++i){
+      scorers.push_back(HmmScorer(new HmmFilter(mix_, mark_), series,
+                                  1 + i, nthreads, paths, probs));
+    }
+    boost::thread_group tg;
+    for(int i = 0; i < nthreads; ++i){
+      tg.add_thread(new boost::thread(boost::ref(scorers[i])));
+    }
+    tg.join_all();
+    for(int i = 0; i < nthreads; ++i){
+      if(!scorers[i].error_message().empty()){
+        report_error(scorers[i].error_message());
+      }
+    }
+#endif
+  }
+
   //======================================================================
 
   HMM_EM::HMM_EM(std::vector<Ptr<EmMixtureComponent> >Mix,
@@ -125,9 +125,9 @@ namespace BOOM{
     P_.resize(n);
     for(int i = 1; i < n; ++i){
       fill_logp(series[i]);
-      fill_logQ(series[i]);
+      fill_Q(series[i]);
       P_[i].resize(S,S);
-      loglike += fwd_1(pi_, P_[i], logQ_, logp_, one_);
+      loglike += fwd_1_scaled(pi_, P_[i], Q_, logp_, one_, wsp_);
     }
     return loglike;
   }
@@ -141,8 +141,8 @@ namespace BOOM{
     Matrix P(S,S);
     for(int i = 0; i < n; ++i){
       fill_logp(series[i], logp_);
-      fill_logQ(series[i], logQ_);
-      loglike += fwd_1(pi_, P, logQ_, logp_, one_);
+      fill_Q(series[i], Q_);
+      loglike += fwd_1_scaled(pi_, P, Q_, logp_, one_, wsp_);
     }
     return loglike;
   }
@@ -202,17 +202,16 @@ namespace BOOM{
   void HealthStateModel::fill_logp(Ptr<HealthStateData> dp){
     fill_logp(dp, logp_); }
 
-  void HealthStateModel::fill_logQ(Ptr<HealthStateData> dp){
-    fill_logQ(dp, logQ_); }
-  void HealthStateModel::fill_logQ(Ptr<HealthStateData> dp, Matrix &logQ)const{
+  void HealthStateModel::fill_Q(Ptr<HealthStateData> dp){
+    fill_Q(dp, Q_); }
+  void HealthStateModel::fill_Q(Ptr<HealthStateData> dp, Matrix &Q)const{
     double alpha = dp->final_treatment_fraction();
     if(alpha >= 1.0){
-      logQ = log(mark_[dp->treatment()]->Q());
+      Q = mark_[dp->treatment()]->Q();
     }else{
       int then = dp->initial_treatment();
       int now = dp->treatment();
-      logQ = log((1-alpha) * mark_[then]->Q() +
-                 alpha * mark_[now]->Q());
+      Q = (1-alpha) * mark_[then]->Q() + alpha * mark_[now]->Q();
     }
   }
 
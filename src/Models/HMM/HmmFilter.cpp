@@ -18,6 +18,7 @@
 
 #include <Models/HMM/HmmFilter.hpp>
 #include <cpputil/math_utils.hpp>
+#include <cpputil/lse.hpp>
 #include <Models/HMM/hmm_tools.hpp>
 
 #include <Models/ModelTypes.hpp>
@@ -25,9 +26,19 @@
 #include <Models/MarkovModel.hpp>
 #include <distributions.hpp>
 #include <cpputil/report_error.hpp>
+#include <LinAlg/SubMatrix.hpp>
+#include <algorithm>
+#include <cmath>
+#include <utility>
 
 namespace BOOM{
 
+  namespace {
+    // The number of time points whose emission densities are computed
+    // together in the forward recursion.
+    const uint kLogDensityBlockSize = 256;
+  }  // namespace
+
   void hmm_recursion_error(const Matrix &p, const Vector &Marg, const Matrix &Tmat,
                            const Vector &Wsp, uint i, Ptr<Data>);
   void hmm_recursion_error(const Matrix &P, const Vector &marg, const Matrix &tmat,
@@ -52,13 +63,42 @@ namespace BOOM{
       logp(mv.size()),
       logpi(mv.size()),
       one(mv.size(), 1.0),
-      logQ(mv.size(), mv.size()),
-      markov_(mark)
+      Q(mv.size(), mv.size()),
+      markov_(mark),
+      memory_budget_(512.0 * 1024 * 1024),
+      checkpoint_interval_(0),
+      current_segment_(-1)
       {}
 
   uint HmmFilter::state_space_size()const{
     return models_.size();}
 
+  void HmmFilter::set_memory_budget(double bytes){
+    if(bytes <= 0){
+      report_error("The memory budget for HmmFilter must be positive.");
+    }
+    memory_budget_ = bytes;
+  }
+
+  void HmmFilter::compute_logp(const Data *dp, Vector &ans)const{
+    uint S = state_space_size();
+    if(ans.size()!=S) ans.resize(S);
+    if(dp->missing()) ans = 0;
+    else for(uint s=0; s<S; ++s) ans[s] = models_[s]->pdf(dp, true);
+  }
+
+  void HmmFilter::fill_log_densities(const std::vector<Ptr<Data> > &dv,
+                                     uint start, uint nrows){
+    uint S = state_space_size();
+    if(logd_block_.nrow() < nrows || logd_block_.ncol() != S){
+      logd_block_.resize(nrows, S);
+    }
+    for(uint s=0; s<S; ++s){
+      VectorView column(logd_block_.col(s), 0, nrows);
+      models_[s]->fill_logp(dv, start, column);
+    }
+  }
+
   double HmmFilter::initialize(const Data * dp){
     uint S = state_space_size();
     pi = markov_->pi0();
@@ -66,44 +106,144 @@ namespace BOOM{
     else for(uint s=0; s<S; ++s) logp[s] = models_[s]->pdf(dp, true);
     pi = log(pi) + logp;
     double m = max(pi);
-    pi = exp(pi-m);
-    double nc = sum(pi);
+    double nc = exp_shifted(pi.data(), m, pi.data(), S);
     double loglike = m + log(nc);
     pi/=nc;
     return loglike;
   }
 
   double HmmFilter::fwd(const std::vector<Ptr<Data> > &dv){
-    logQ = log(markov_->Q() );
+    Q = markov_->Q();
     uint n = dv.size();
     uint S = state_space_size();
     if(logp.size()!=S) logp.resize(S);
-    if(P.size() < n) P.resize(n);
+    current_segment_ = -1;
+    double full_storage_bytes = double(n) * S * S * sizeof(double);
+    if(full_storage_bytes <= memory_budget_){
+      checkpoint_interval_ = 0;
+      if(P.size() < n) P.resize(n);
+      double loglike = initialize(dv[0].get());
+      for(uint start=1; start<n; start += kLogDensityBlockSize){
+        uint nrows = std::min(kLogDensityBlockSize, n - start);
+        fill_log_densities(dv, start, nrows);
+        for(uint t=0; t<nrows; ++t){
+          logp = logd_block_.row(t);
+          loglike += fwd_1_scaled(pi, P[start + t], Q, logp, one, wsp_);
+        }
+      }
+      return loglike;
+    }
+
+    // Checkpointed storage.  Release the full-storage matrices, which
+    // might be left over from a shorter series.
+    std::vector<Mat>().swap(P);
+    checkpoint_interval_ = lround(ceil(sqrt(double(n))));
+    checkpoints_.resize(1 + (n - 1) / checkpoint_interval_);
+    segment_.resize(checkpoint_interval_);
+    Matrix &work(segment_[0]);
     double loglike = initialize(dv[0].get());
-    for(uint i=1; i<n; ++i){
-      if(dv[i]->missing()) logp = 0;
-      else for(uint s=0; s<S; ++s) logp[s] = models_[s]->pdf(dv[i].get(), true);
-      loglike += fwd_1(pi, P[i], logQ, logp, one);
+    checkpoints_[0] = pi;
+    // The log densities are computed one segment at a time, exactly as
+    // they will be recomputed by recompute_segment().
+    for(uint start=1; start<n; start += checkpoint_interval_){
+      uint nrows = std::min<uint>(checkpoint_interval_, n - start);
+      fill_log_densities(dv, start, nrows);
+      for(uint t=0; t<nrows; ++t){
+        logp = logd_block_.row(t);
+        loglike += fwd_1_scaled(pi, work, Q, logp, one, wsp_);
+      }
+      uint i = start + nrows - 1;
+      if(i % checkpoint_interval_ == 0){
+        checkpoints_[i / checkpoint_interval_] = pi;
+      }
     }
     return loglike;
   }
   //------------------------------------------------------------
+  void HmmFilter::recompute_segment(const std::vector<Ptr<Data> > &dv,
+                                    int segment){
+    uint n = dv.size();
+    uint start = segment * checkpoint_interval_;
+    uint end = std::min<uint>(start + checkpoint_interval_, n - 1);
+    segment_pi_ = checkpoints_[segment];
+    fill_log_densities(dv, start + 1, end - start);
+    for(uint t = start + 1; t <= end; ++t){
+      segment_logp_ = logd_block_.row(t - start - 1);
+      fwd_1_scaled(segment_pi_, segment_[t - start - 1], Q, segment_logp_,
+                   one, wsp_);
+    }
+    current_segment_ = segment;
+  }
+  //------------------------------------------------------------
+  Matrix & HmmFilter::transition_distribution(
+      const std::vector<Ptr<Data> > &dv, uint i){
+    if(checkpoint_interval_ == 0) return P[i];
+    int segment = (i - 1) / checkpoint_interval_;
+    if(segment != current_segment_) recompute_segment(dv, segment);
+    return segment_[i - 1 - segment * checkpoint_interval_];
+  }
+  //------------------------------------------------------------
 
   double HmmFilter::loglike(const std::vector<Ptr<Data> > & dv){
-    logQ = log(markov_->Q());
-    pi = markov_->pi0();
-    uint S = pi.size();
+    Q = markov_->Q();
     uint n = dv.size();
-    Matrix P(logQ);
+    Matrix P(Q);
     double ans = initialize(dv[0].get());
-    for(uint i=1; i<n; ++i){
-      if(dv[i]->missing()) logp = 0;
-      else for(uint s=0; s<S; ++s) logp[s] = models_[s]->pdf(dv[i].get(), true);
-      ans += fwd_1(pi, P, logQ, logp, one);
+    for(uint start=1; start<n; start += kLogDensityBlockSize){
+      uint nrows = std::min(kLogDensityBlockSize, n - start);
+      fill_log_densities(dv, start, nrows);
+      for(uint t=0; t<nrows; ++t){
+        logp = logd_block_.row(t);
+        ans += fwd_1_scaled(pi, P, Q, logp, one, wsp_);
+      }
     }
     return ans;
   }
   //------------------------------------------------------------
+  double HmmFilter::loglike(
+      const std::vector<const std::vector<Ptr<Data> > *> &series){
+    Q = markov_->Q();
+    uint S = state_space_size();
+    // Order the series from longest to shortest, so the series still
+    // active at any time step occupy the leading rows of Pi.
+    std::vector<std::pair<uint, uint> > order;
+    for(uint k=0; k<series.size(); ++k){
+      if(!series[k]->empty()) order.push_back(std::make_pair(
+          series[k]->size(), k));
+    }
+    std::sort(order.rbegin(), order.rend());
+    uint nseries = order.size();
+    if(nseries == 0) return 0;
+
+    Matrix Pi(nseries, S);
+    Vector loglike(nseries);
+    for(uint k=0; k<nseries; ++k){
+      loglike[k] = initialize((*series[order[k].second])[0].get());
+      Pi.row(k) = pi;
+    }
+
+    Matrix logD(nseries, S);
+    // Log likelihood of the series that have already ended.
+    double finished = 0;
+    uint max_length = order[0].first;
+    for(uint t=1; t<max_length; ++t){
+      uint nactive = nseries;
+      while(order[nactive - 1].first <= t) --nactive;
+      if(nactive < Pi.nrow()){
+        Pi = Matrix(ConstSubMatrix(Pi, 0, nactive - 1, 0, S - 1));
+        logD.resize(nactive, S);
+        for(uint k=nactive; k<loglike.size(); ++k) finished += loglike[k];
+        loglike.resize(nactive);
+      }
+      for(uint k=0; k<nactive; ++k){
+        compute_logp((*series[order[k].second])[t].get(), logp);
+        logD.row(k) = logp;
+      }
+      fwd_1_batch(Pi, Q, logD, loglike);
+    }
+    return finished + sum(loglike);
+  }
+  //------------------------------------------------------------
 
   void HmmFilter::bkwd_sampling_mt(const std::vector<Ptr<Data> > &dv,
                                    RNG & eng){
@@ -114,7 +254,7 @@ namespace BOOM{
     uint s = rmulti_mt(eng,pi);
     models_[s]->add_data(dv.back());
     for(uint i=n-1; i!=0; --i){
-      pi = P[i].col(s);
+      pi = transition_distribution(dv, i).col(s);
       pi.normalize_prob();
       uint r = rmulti_mt(eng,pi);
       models_[r]->add_data(dv[i-1]);
@@ -134,7 +274,7 @@ namespace BOOM{
     allocate(dv.back(), s);             // last data point allocated
 
     for(uint i=n-1; i!=0; --i){         // start with s=h[i]
-      pi = P[i].col(s);                 // compute r = h[i-1]
+      pi = transition_distribution(dv, i).col(s);  // compute r = h[i-1]
       uint r = rmulti(pi);
       allocate(dv[i-1], r);
       markov_->suf()->add_transition(r,s);
@@ -144,6 +284,38 @@ namespace BOOM{
     // in last step of loop i = 1, so s=h[0]
   }
   //----------------------------------------------------------------------
+  std::vector<int> HmmFilter::most_likely_states(
+      const std::vector<Ptr<Data> > &dv){
+    uint n = dv.size();
+    if(n == 0) return std::vector<int>();
+    logQ_ = log(markov_->Q());
+    compute_logp(dv[0].get(), logp);
+    ViterbiRecursion viterbi;
+    viterbi.initialize(log(markov_->pi0()) + logp);
+    for(uint start=1; start<n; start += kLogDensityBlockSize){
+      uint nrows = std::min(kLogDensityBlockSize, n - start);
+      fill_log_densities(dv, start, nrows);
+      for(uint t=0; t<nrows; ++t){
+        logp = logd_block_.row(t);
+        viterbi.update(logQ_, logp);
+      }
+    }
+    return viterbi.most_likely_path();
+  }
+  //----------------------------------------------------------------------
+  Matrix HmmFilter::state_probabilities(const std::vector<Ptr<Data> > &dv){
+    uint n = dv.size();
+    Matrix ans(n, state_space_size());
+    if(n == 0) return ans;
+    fwd(dv);
+    ans.row(n-1) = pi;
+    for(uint i=n-1; i!=0; --i){
+      bkwd_1(pi, transition_distribution(dv, i), wsp_, one);
+      ans.row(i-1) = pi;
+    }
+    return ans;
+  }
+  //----------------------------------------------------------------------
   void HmmFilter::allocate(Ptr<Data> dp, uint h){
     models_[h]->add_data(dp);
   }
@@ -196,10 +368,11 @@ namespace BOOM{
     uint S = state_space_size();
     for(uint i=n-1; i!=0; --i){
       for(uint s=0; s<S; ++s) models_[s]->add_mixture_data(dv[i], pi[s]);
-      markov_->suf()->add_transition_distribution(P[i]);
-      bkwd_1(pi, P[i], logp, one);
+      Matrix &transition(transition_distribution(dv, i));
+      markov_->suf()->add_transition_distribution(transition);
+      bkwd_1(pi, transition, logp, one);
     }
-    pi = P[1] * one;
+    pi = transition_distribution(dv, 1) * one;
     for(uint s=0; s<S; ++s) models_[s]->add_mixture_data(dv[0], pi[s]);
     markov_->suf()->add_initial_distribution(pi);
   }
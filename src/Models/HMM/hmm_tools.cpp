@@ -2,6 +2,9 @@
 #include <uint.hpp>
 #include <LinAlg/Matrix.hpp>
 #include <LinAlg/Vector.hpp>
+#include <cpputil/lse.hpp>
+#include <cmath>
+#include <limits>
 
 namespace BOOM{
   using BOOM::uint;
@@ -44,10 +47,126 @@ namespace BOOM{
        * Output  pi is prob(h[t-1] | Y[n])
        *         P is prob(h[t-1],h[t] | Y[n])
        *----------------------------------------------------------------------*/
-      wsp = pi/(one * P);   // ratio of new pi to old pi
+      wsp = one * P;
       uint S = pi.size();
+      // Ratio of new pi to old pi.  States with zero filtered
+      // probability also have zero smoothed probability.
+      for(uint s=0; s<S; ++s) wsp[s] = wsp[s] > 0 ? pi[s] / wsp[s] : 0;
       for(uint r=0; r<S; ++r) P.row(r) *= wsp;
       pi = P * one;
     }
 
+    double fwd_1_scaled(Vector &pi, Matrix &P, const Matrix &Q,
+                        const Vector &logd, const Vector &one, Vector &wsp){
+      /*----------------------------------------------------------------------
+       * P(r,s) = pi[r] * Q(r,s) * d[s] / nc, where d[s] = exp(logd[s] - m)
+       * is scaled so its largest element is 1, and nc normalizes P.
+       * The log normalizing constant is m + log(nc).
+       *----------------------------------------------------------------------*/
+      uint S = pi.size();
+      if(P.nrow() != S || P.ncol() != S) P.resize(S,S);
+      if(wsp.size() != S) wsp.resize(S);
+      double m = max(logd);
+      exp_shifted(logd.data(), m, wsp.data(), S);
+
+      const double *q = Q.data();
+      double *p = P.data();
+      const double *prior = pi.data();
+      double nc = 0;
+      for(uint s=0; s<S; ++s){       // column major storage
+        double d = wsp[s];
+        for(uint r=0; r<S; ++r){
+          double value = prior[r] * q[r] * d;
+          p[r] = value;
+          nc += value;
+        }
+        q += S;
+        p += S;
+      }
+
+      if(!std::isfinite(m) || !std::isfinite(nc)
+         || nc < std::numeric_limits<double>::min()){
+        return fwd_1(pi, P, log(Q), logd, one);
+      }
+      P /= nc;
+      pi = one * P;
+      return m + log(nc);
+    }
+
+    void fwd_1_batch(Matrix &Pi, const Matrix &Q, const Matrix &logD,
+                     Vector &loglike){
+      uint nseq = Pi.nrow();
+      uint S = Pi.ncol();
+      Matrix pred = Pi * Q;   // pred(k, s) = p(h[t] = s | Y[t-1]) for seq k
+      Matrix logQ, P;
+      Vector one, pi;
+      for(uint k=0; k<nseq; ++k){
+        double m = max(logD.row(k));
+        double nc = 0;
+        for(uint s=0; s<S; ++s){
+          pred(k, s) *= exp(logD(k, s) - m);
+          nc += pred(k, s);
+        }
+        if(std::isfinite(m) && std::isfinite(nc)
+           && nc >= std::numeric_limits<double>::min()){
+          Pi.row(k) = pred.row(k) / nc;
+          loglike[k] += m + log(nc);
+        }else{
+          // Underflow.  Redo this sequence's step on the log scale.
+          if(logQ.nrow() != S){
+            logQ = log(Q);
+            one.resize(S);
+            one = 1.0;
+          }
+          pi = Pi.row(k);
+          loglike[k] += fwd_1(pi, P, logQ, logD.row(k), one);
+          Pi.row(k) = pi;
+        }
+      }
+    }
+
+    //======================================================================
+    void ViterbiRecursion::initialize(const Vector &log_initial){
+      nstates_ = log_initial.size();
+      ntimes_ = 1;
+      delta_ = log_initial;
+      next_.resize(nstates_);
+      backpointers_.clear();
+    }
+
+    void ViterbiRecursion::update(const Matrix &logQ, const Vector &logd){
+      backpointers_.reserve(backpointers_.size() + nstates_);
+      for(int s=0; s<nstates_; ++s){
+        const double *log_transition = logQ.col(s).data();
+        int best_state = 0;
+        double best = delta_[0] + log_transition[0];
+        for(int r=1; r<nstates_; ++r){
+          double candidate = delta_[r] + log_transition[r];
+          if(candidate > best){
+            best = candidate;
+            best_state = r;
+          }
+        }
+        next_[s] = best + logd[s];
+        backpointers_.push_back(best_state);
+      }
+      delta_.swap(next_);
+      ++ntimes_;
+    }
+
+    std::vector<int> ViterbiRecursion::most_likely_path()const{
+      std::vector<int> ans(ntimes_);
+      int state = delta_.imax();
+      ans.back() = state;
+      for(int t = ntimes_ - 1; t > 0; --t){
+        state = backpointers_[(t - 1) * nstates_ + state];
+        ans[t - 1] = state;
+      }
+      return ans;
+    }
+
+    double ViterbiRecursion::log_probability()const{
+      return max(delta_);
+    }
+
 }
@@ -29,6 +29,7 @@
 
 #include <distributions/Markov.hpp>
 #include <stdexcept>
+#include <boost/bind.hpp>
 
 #include <LinAlg/Matrix.hpp>
 #include <LinAlg/VectorView.hpp>
@@ -199,6 +200,11 @@ namespace BOOM{
     }
   }
 
+  void MarkovSuf::add_mixture_data(int then, int now, double prob){
+    if(then < 0) init_(now) += prob;
+    else trans_(then, now) += prob;
+  }
+
   std::ostream &MarkovSuf::print(std::ostream &out)const{
     trans_.write(out, false);
     out << " ";
@@ -351,6 +357,7 @@ namespace BOOM{
       PriorPolicy(),
       LoglikeModel()
   {
+    set_observers();
     fix_pi0_uniform();
   }
 
@@ -359,6 +366,7 @@ namespace BOOM{
 		  new VectorParams(Q.nrow())),
       DataPolicy(new MarkovSuf(Q.nrow()))
   {
+    set_observers();
     fix_pi0_uniform();
   }
 
@@ -367,6 +375,7 @@ namespace BOOM{
 		  new VectorParams(Pi0)),
       DataPolicy(new MarkovSuf(Q.nrow()))
   {
+    set_observers();
   }
 
   template<class T>
@@ -382,6 +391,7 @@ namespace BOOM{
     NEW(TPM, Q1)(S);
     NEW(VectorParams, Pi0)(S);
     ParamPolicy::set_params(Q1, Pi0);
+    set_observers();
 
     Ptr<MarkovDataSeries> ts = make_markov_data(idata);
     add_data_series(ts);
@@ -395,6 +405,7 @@ namespace BOOM{
     NEW(TPM, Q1)(S);
     NEW(VectorParams, Pi0)(S);
     ParamPolicy::set_params(Q1, Pi0);
+    set_observers();
 
     Ptr<MarkovDataSeries> ts = make_markov_data(sdata);
     add_data_series(ts);
@@ -411,7 +422,9 @@ namespace BOOM{
       LoglikeModel(rhs),
       EmMixtureComponent(rhs),
       pi0_status(rhs.pi0_status)
-  {}
+  {
+    set_observers();
+  }
 
   MarkovModel * MarkovModel::clone()const{return new MarkovModel(*this);}
 
@@ -516,6 +529,51 @@ namespace BOOM{
   Vector MarkovModel::stat_dist()const{
     return get_stat_dist(Q()); }
 
+  uint MarkovModel::simulate_initial_state(RNG &rng)const{
+    if(!initial_state_sampler_current_){
+      initial_state_sampler_.set_probabilities(pi0());
+      initial_state_sampler_current_ = true;
+    }
+    return initial_state_sampler_.draw(rng);
+  }
+
+  uint MarkovModel::simulate_transition(RNG &rng, uint from)const{
+    uint S = state_space_size();
+    if(transition_samplers_.size() != S){
+      transition_samplers_.resize(S);
+      transition_samplers_current_.assign(S, false);
+    }
+    if(!transition_samplers_current_[from]){
+      transition_samplers_[from].set_probabilities(Q().row(from));
+      transition_samplers_current_[from] = true;
+    }
+    return transition_samplers_[from].draw(rng);
+  }
+
+  std::vector<uint> MarkovModel::simulate(int length, RNG &rng)const{
+    std::vector<uint> ans;
+    if(length <= 0) return ans;
+    ans.reserve(length);
+    ans.push_back(simulate_initial_state(rng));
+    for(int t = 1; t < length; ++t){
+      ans.push_back(simulate_transition(rng, ans.back()));
+    }
+    return ans;
+  }
+
+  void MarkovModel::set_observers(){
+    // Data::add_observer is hidden by the TransitionProbabilityMatrix
+    // overload taking a Ptr<VectorParams>.
+    Q_prm()->Data::add_observer(boost::bind(&MarkovModel::observe_Q, this));
+    Pi0_prm()->add_observer(boost::bind(&MarkovModel::observe_pi0, this));
+    initial_state_sampler_current_ = false;
+    transition_samplers_current_.assign(transition_samplers_.size(), false);
+  }
+
+  void MarkovModel::observe_Q(){
+    transition_samplers_current_.assign(transition_samplers_.size(), false);
+  }
+
   void MarkovModel::fix_pi0(const Vector &Pi0){
     set_pi0(Pi0);
     pi0_status=Known;  }
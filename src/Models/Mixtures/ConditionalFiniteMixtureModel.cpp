@@ -188,10 +188,11 @@ namespace BOOM {
                   data_point.data(),
                   true);
         }
-        last_loglike_ += lse(wsp_);
-        wsp_.normalize_logprob();
+        double log_normalizing_constant;
+        int mixture_indicator = rmulti_logprob_mt(
+            rng, wsp_, &log_normalizing_constant);
+        last_loglike_ += log_normalizing_constant;
         class_membership_probabilities_.row(i) = wsp_;
-        int mixture_indicator = rmulti_mt(rng, wsp_);
         set_mixture_component_for_observation(i, mixture_indicator);
         mixture_component(mixture_indicator)->add_data(
             data_point.shared_data());
@@ -173,4 +173,14 @@ namespace BOOM{
   double DiffVectorModel::d2logp(const Vector &x, Vector &g, Matrix &h)const{
     return Logp(x,g,h,2);}
 
+  //======================================================================
+  void MixtureComponent::fill_logp(const std::vector<Ptr<Data> > &data,
+                                   int start,
+                                   VectorView ans)const{
+    for(int i = 0; i < ans.size(); ++i){
+      const Data *dp = data[start + i].get();
+      ans[i] = dp->missing() ? 0 : pdf(dp, true);
+    }
+  }
+
 }  // namespace BOOM
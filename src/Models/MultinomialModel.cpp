@@ -215,6 +215,24 @@ namespace BOOM{
     return logscale ? logp_[i] : pi(i);
   }
 
+  void MM::fill_logp(const std::vector<Ptr<Data> > &data,
+                     int start,
+                     VectorView ans)const{
+    check_logp();
+    for(int i = 0; i < ans.size(); ++i){
+      const Data *dp = data[start + i].get();
+      if(dp->missing()){
+        ans[i] = 0;
+        continue;
+      }
+      uint level = DAT(dp)->value();
+      if(level >= dim()){
+        report_error("too large a value passed to MultinomialModel::fill_logp");
+      }
+      ans[i] = logp_[level];
+    }
+  }
+
   uint MM::simdat()const{ return rmulti(pi()); }
 
   void MM::add_mixture_data(Ptr<Data> dp, double prob){
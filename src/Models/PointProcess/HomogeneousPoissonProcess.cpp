@@ -159,6 +159,11 @@ namespace BOOM{
     suf()->update_raw(data);
   }
 
+  void HomogeneousPoissonProcess::add_data_raw(
+      const PackedPointProcess &data){
+    suf()->update_raw(data.number_of_events(), data.window_duration());
+  }
+
   double HomogeneousPoissonProcess::loglike(
       const Vector &scalar_lambda_vector)const{
     int x = suf()->count();
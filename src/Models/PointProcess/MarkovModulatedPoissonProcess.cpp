@@ -20,12 +20,19 @@
 
 #include <algorithm>
 #include <iterator>  // for back_inserter
+#include <map>
+#include <string>
 #include <vector>
 
 #include <cpputil/lse.hpp>
 #include <cpputil/math_utils.hpp>
 #include <cpputil/report_error.hpp>
 #include <distributions.hpp>
+#include <Models/HMM/hmm_tools.hpp>
+
+#ifndef NO_BOOST_THREADS
+#include <boost/thread.hpp>
+#endif
 
 namespace BOOM{
 
@@ -48,17 +55,20 @@ namespace BOOM{
     // If they are a bottleneck then consider using sorted ranges instead.
 
     // Args:
-    //   P:  A reference to a Matrix full of un-normalized log probabilities.
+    //   P: A reference to a Vector full of un-normalized log
+    //     probabilities, one for each legal transition.
     // Returns:
     //   Safely exponentiates everything in P, normalizes P so that
     //   the sum over all its elements is 1, and returns the log of
     //   the normalizing constant (which is the contribution of the
     //   most recent data point to log likelihood).
-    double normalize_filter(Matrix &P){
+    double normalize_filter(Vector &P){
       double max_log = max(P);
-      P -= max_log;
-      P.exp();
-      double total = sum(P);
+      double total = 0;
+      for(int k = 0; k < P.size(); ++k){
+        P[k] = exp(P[k] - max_log);
+        total += P[k];
+      }
       P /= total;
       return max_log + log(total);
     }
@@ -74,6 +84,80 @@ namespace BOOM{
       }
       return ans;
     }
+
+    typedef std::map<const PoissonProcess *, Ptr<PoissonProcess> >
+    ProcessCloneMap;
+
+    // Returns the clones of the processes in 'processes'.
+    std::vector<Ptr<PoissonProcess> > find_clones(
+        const std::vector<PoissonProcess *> &processes,
+        ProcessCloneMap &clones){
+      std::vector<Ptr<PoissonProcess> > ans;
+      ans.reserve(processes.size());
+      for(int i = 0; i < processes.size(); ++i){
+        ans.push_back(clones[processes[i]]);
+      }
+      return ans;
+    }
+
+    // Imputes the latent data for every stride'th data series,
+    // starting with 'first'.  The imputed data are attributed to the
+    // components of 'worker', which must be a copy of the model that
+    // owns the data.
+    class MmppImputer {
+     public:
+      typedef MarkovModulatedPoissonProcess::SourceVector SourceVector;
+      MmppImputer(MarkovModulatedPoissonProcess *worker,
+                  const std::vector<Ptr<PointProcess> > &data,
+                  const std::vector<const SourceVector *> &sources,
+                  std::vector<Matrix> &probability_of_activity,
+                  std::vector<Matrix> &probability_of_responsibility,
+                  int first,
+                  int stride,
+                  unsigned long seed)
+          : worker_(worker),
+            data_(&data),
+            sources_(&sources),
+            activity_(&probability_of_activity),
+            responsibility_(&probability_of_responsibility),
+            first_(first),
+            stride_(stride),
+            rng_(seed),
+            loglike_(0)
+      {}
+
+      void operator()(){
+        try{
+          for(int i = first_; i < data_->size(); i += stride_){
+            const PointProcess &process(*(*data_)[i]);
+            loglike_ += worker_->filter(process, *(*sources_)[i]);
+            worker_->backward_sampling(rng_,
+                                       process,
+                                       (*activity_)[i],
+                                       (*responsibility_)[i]);
+          }
+        }catch(const std::exception &e){
+          error_message_ = e.what();
+        }catch(...){
+          error_message_ = "Unknown exception while imputing an MMPP.";
+        }
+      }
+
+      double loglike()const{return loglike_;}
+      const std::string &error_message()const{return error_message_;}
+
+     private:
+      MarkovModulatedPoissonProcess *worker_;
+      const std::vector<Ptr<PointProcess> > *data_;
+      const std::vector<const SourceVector *> *sources_;
+      std::vector<Matrix> *activity_;
+      std::vector<Matrix> *responsibility_;
+      int first_;
+      int stride_;
+      RNG rng_;
+      double loglike_;
+      std::string error_message_;
+    };
   }
   //======================================================================
   namespace MmppHelper {
@@ -350,20 +434,154 @@ namespace BOOM{
       }
       return it->second;
     }
+
+    //======================================================================
+    TransitionGraph::TransitionGraph()
+        : outgoing_start_(1, 0),
+          incoming_start_(1, 0),
+          culprit_start_(1, 0),
+          active_start_(1, 0)
+    {}
+
+    namespace {
+      bool precedes(const HmmState *lhs, const HmmState *rhs){
+        return lhs->id_number() < rhs->id_number();
+      }
+    }  // namespace
+
+    TransitionGraph::TransitionGraph(const std::vector<Ptr<HmmState> > &states,
+                                     const ProcessInfo &process_info){
+      int S = states.size();
+      outgoing_start_.reserve(S + 1);
+      active_start_.reserve(S + 1);
+      culprit_start_.push_back(0);
+      for(int r = 0; r < S; ++r){
+        const HmmState *state = states[r].get();
+        outgoing_start_.push_back(to_.size());
+        active_start_.push_back(active_ids_.size());
+        const std::vector<PoissonProcess *> &active(state->active_processes());
+        for(int i = 0; i < active.size(); ++i){
+          active_ids_.push_back(process_info.process_id(active[i]));
+        }
+
+        std::vector<HmmState *> destinations(
+            state->potential_outgoing_transitions());
+        std::sort(destinations.begin(), destinations.end(), precedes);
+        for(int i = 0; i < destinations.size(); ++i){
+          from_.push_back(r);
+          to_.push_back(destinations[i]->id_number());
+          const std::vector<PoissonProcess *> &culprits(
+              state->processes_transitioning_to(destinations[i]));
+          for(int j = 0; j < culprits.size(); ++j){
+            culprits_.push_back(culprits[j]);
+            culprit_ids_.push_back(process_info.process_id(culprits[j]));
+          }
+          culprit_start_.push_back(culprits_.size());
+        }
+      }
+      outgoing_start_.push_back(to_.size());
+      active_start_.push_back(active_ids_.size());
+
+      // Transitions are numbered in order of their origin, so a
+      // counting sort by destination lists each state's incoming
+      // transitions in order of origin.
+      incoming_start_.assign(S + 1, 0);
+      for(int k = 0; k < to_.size(); ++k){
+        ++incoming_start_[to_[k] + 1];
+      }
+      for(int s = 0; s < S; ++s){
+        incoming_start_[s + 1] += incoming_start_[s];
+      }
+      incoming_.resize(to_.size());
+      std::vector<int> position(incoming_start_.begin(),
+                                incoming_start_.end() - 1);
+      for(int k = 0; k < to_.size(); ++k){
+        incoming_[position[to_[k]]++] = k;
+      }
+    }
+
+    int TransitionGraph::find(int r, int s)const{
+      std::vector<int>::const_iterator begin = to_.begin() + outgoing_begin(r);
+      std::vector<int>::const_iterator end = to_.begin() + outgoing_end(r);
+      std::vector<int>::const_iterator it = std::lower_bound(begin, end, s);
+      if(it == end || *it != s) return -1;
+      return it - to_.begin();
+    }
+
+    double TransitionGraph::cumulative_hazard(
+        int r, int t, const ProcessInfo &process_info)const{
+      double ans = 0;
+      for(int i = active_start_[r]; i < active_start_[r + 1]; ++i){
+        ans += process_info.cumulative_hazard(active_ids_[i], t);
+      }
+      return ans;
+    }
+
+    double TransitionGraph::event_loglikelihood(
+        int k, int t, const ProcessInfo &process_info, Vector &wsp)const{
+      int begin = culprits_begin(k);
+      int nproc = culprits_end(k) - begin;
+      if(nproc == 1){
+        return culprit_log_density(begin, t, process_info);
+      } else if(nproc < 1){
+        report_error("A transition with no responsible process was found in "
+                     "TransitionGraph::event_loglikelihood.");
+      }
+      wsp.resize(nproc);
+      for(int i = 0; i < nproc; ++i){
+        wsp[i] = culprit_log_density(begin + i, t, process_info);
+      }
+      return lse(wsp);
+    }
   } // namespace MmppHelper
   //======================================================================
   typedef MarkovModulatedPoissonProcess MMPP;
 
   MMPP::MarkovModulatedPoissonProcess() {}
 
+  // The components are registered with add_component_process in the
+  // same order as in rhs, so process ids, parameter vectors, and the
+  // rows of the probability_of_ matrices line up with rhs.
   MMPP::MarkovModulatedPoissonProcess(const MMPP &rhs)
       : Model(rhs),
-        ParamPolicy(rhs),
-        DataPolicy(rhs)
+        DataPolicy(rhs),
+        PriorPolicy(rhs),
+        last_loglike_(rhs.last_loglike_),
+        probability_of_activity_(rhs.probability_of_activity_),
+        probability_of_responsibility_(rhs.probability_of_responsibility_),
+        known_source_store_(rhs.known_source_store_)
   {
-    // What to do with component processes?  Clone them?  Copy them?
-    // Probably clone them.
-    report_error("MMPP copy constructor not yet implemented.");
+    ProcessCloneMap processes;
+    for(int i = 0; i < rhs.component_processes_.size(); ++i){
+      const PoissonProcess *process = rhs.component_processes_[i].get();
+      processes[process] = process->clone();
+    }
+    std::map<const MixtureComponent *, Ptr<MixtureComponent> > components;
+    for(int i = 0; i < rhs.mixture_components_.size(); ++i){
+      const MixtureComponent *component = rhs.mixture_components_[i].get();
+      components[component] = component->clone();
+    }
+
+    std::vector<const PoissonProcess *> add_order(rhs.process_id_.size());
+    for(boost::unordered_map<const PoissonProcess *, int>::const_iterator it =
+            rhs.process_id_.begin(); it != rhs.process_id_.end(); ++it){
+      add_order[it->second] = it->first;
+    }
+    for(int i = 0; i < add_order.size(); ++i){
+      const PoissonProcess *process = add_order[i];
+      std::map<const PoissonProcess *, MixtureComponent *>::const_iterator
+          emits = rhs.emits_.find(process);
+      add_component_process(
+          processes[process],
+          find_clones(rhs.spawns_.find(process)->second, processes),
+          find_clones(rhs.kills_.find(process)->second, processes),
+          emits == rhs.emits_.end() ? Ptr<MixtureComponent>()
+          : components[emits->second]);
+    }
+    if(!rhs.hmm_states_.empty()){
+      make_hmm_states(find_clones(rhs.hmm_states_[0]->active_processes(),
+                                  processes));
+    }
   }
 
   MMPP * MMPP::clone()const{return new MMPP(*this);}
@@ -536,6 +754,11 @@ namespace BOOM{
   // backward simulation algorithm.  Returns the observed-data log
   // likelihood of the current set of model parameters.
   double MMPP::impute_latent_data(RNG &rng){
+#ifndef NO_BOOST_THREADS
+    if(!workers_.empty()){
+      return impute_latent_data_with_threads(rng);
+    }
+#endif
     const std::vector<Ptr<PointProcess> > &data(dat());
     double loglike = 0;
     clear_client_data();
@@ -552,6 +775,82 @@ namespace BOOM{
     return loglike;
   }
 
+  //----------------------------------------------------------------------
+  void MMPP::set_nthreads(int n){
+    workers_.clear();
+#ifndef NO_BOOST_THREADS
+    if(n <= 1) return;
+    for(int i = 0; i < n; ++i){
+      Ptr<MMPP> worker(clone());
+      worker->clear_data();
+      workers_.push_back(worker);
+    }
+#endif
+  }
+
+  int MMPP::nthreads()const{
+    return workers_.empty() ? 1 : workers_.size();
+  }
+
+  //----------------------------------------------------------------------
+  // Each worker filters and samples a disjoint subset of the data
+  // series, writing directly into that series' probability_of_
+  // matrices.  The data attributed to the workers' components are
+  // then combined into the components of this model.
+  double MMPP::impute_latent_data_with_threads(RNG &rng){
+    double loglike = 0;
+#ifndef NO_BOOST_THREADS
+    const std::vector<Ptr<PointProcess> > &data(dat());
+    clear_client_data();
+    // Look up the sources here, because operator[] modifies the map.
+    std::vector<const SourceVector *> sources(data.size());
+    for(int i = 0; i < data.size(); ++i){
+      sources[i] = &known_source_store_[data[i].get()];
+    }
+
+    int nworkers = workers_.size();
+    Vector params = vectorize_params();
+    std::vector<MmppImputer> imputers;
+    imputers.reserve(nworkers);
+    for(int w = 0; w < nworkers; ++w){
+      workers_[w]->unvectorize_params(params);
+      workers_[w]->clear_client_data();
+      imputers.push_back(MmppImputer(workers_[w].get(),
+                                     data,
+                                     sources,
+                                     probability_of_activity_,
+                                     probability_of_responsibility_,
+                                     w,
+                                     nworkers,
+                                     seed_rng(rng)));
+    }
+    boost::thread_group tg;
+    for(int w = 0; w < nworkers; ++w){
+      tg.add_thread(new boost::thread(boost::ref(imputers[w])));
+    }
+    tg.join_all();
+
+    for(int w = 0; w < nworkers; ++w){
+      if(!imputers[w].error_message().empty()){
+        report_error(imputers[w].error_message());
+      }
+      loglike += imputers[w].loglike();
+      const MMPP &worker(*workers_[w]);
+      for(int i = 0; i < component_processes_.size(); ++i){
+        component_processes_[i]->combine_data(
+            *worker.component_processes_[i], true);
+      }
+      for(int i = 0; i < mixture_components_.size(); ++i){
+        mixture_components_[i]->combine_data(
+            *worker.mixture_components_[i], true);
+      }
+    }
+#endif
+    last_loglike_ = loglike;
+    return loglike;
+  }
+
+  //----------------------------------------------------------------------
   void MMPP::burn(){
     for (int i = 0; i < probability_of_responsibility_.size(); ++i) {
       probability_of_responsibility_[i] = 0;
@@ -606,8 +905,8 @@ namespace BOOM{
   // Details:
   //   On exit, pi0_ contains the marginal distribution of the final
   //   HmmState corresponding to the last event in process, and
-  //   filter_[t] contains the joint distribution of HMM states t-1
-  //   (rows) and t (columns).
+  //   filter_[t][k] is the probability that the transition from
+  //   HMM state t-1 to state t was transition k in transitions_.
   double MMPP::filter(const PointProcess &process, const SourceVector &source){
     if(process.number_of_events() == 0) return 0;
     bool have_source = !source.empty();
@@ -637,27 +936,100 @@ namespace BOOM{
   //   log p(events[t] | events[0, ..., t-1])
   double MMPP::fwd_1(int t,
                      const ProcessInfo &process_info){
-    Matrix &P(filter_[t]);      // Do we need a sparse matrix here?
-    P = negative_infinity();
+    Vector &P(filter_[t]);
+    fill_log_joint(t, process_info, log(pi0_), P);
+    double loglike = normalize_filter(P);
+    pi0_ = 0.0;
+    for(int k = 0; k < P.size(); ++k){
+      pi0_[transitions_.to(k)] += P[k];
+    }
+    return loglike;
+  }
+
+  //----------------------------------------------------------------------
+  void MMPP::fill_log_joint(int t,
+                            const ProcessInfo &process_info,
+                            const Vector &log_prior,
+                            Vector &log_joint)const{
+    log_joint.resize(transitions_.number_of_transitions());
     int S = hmm_state_space_size();
     for(int r = 0; r < S; ++r){
-      const HmmState *first_state = hmm_states_[r].get();
-      double log_prior_hazard = log(pi0_[r])
-          - process_info.conditional_cumulative_hazard(first_state, t);
-      typedef std::vector<HmmState *> StateVector;
-      const StateVector &potential_states(
-          first_state->potential_outgoing_transitions());
-      for(StateVector::const_iterator it = potential_states.begin();
-          it != potential_states.end(); ++it) {
-        const HmmState *second_state = *it;
-        int s = second_state->id_number();
-        P(r, s) = log_prior_hazard + conditional_event_loglikelihood(
-            t, first_state, second_state, process_info);
+      int begin = transitions_.outgoing_begin(r);
+      int end = transitions_.outgoing_end(r);
+      if(begin == end) continue;
+      double log_prior_hazard = log_prior[r]
+          - transitions_.cumulative_hazard(r, t, process_info);
+      for(int k = begin; k < end; ++k){
+        log_joint[k] = log_prior_hazard + transitions_.event_loglikelihood(
+            k, t, process_info, mutable_workspace_);
       }
     }
-    double loglike = normalize_filter(P);
-    pi0_ = one_ * P;
-    return loglike;
+  }
+
+  //----------------------------------------------------------------------
+  std::vector<int> MMPP::most_likely_states(const PointProcess &process,
+                                            const SourceVector &source){
+    int S = hmm_state_space_size();
+    int n = process.number_of_events();
+    if(n == 0) return std::vector<int>(1, 0);
+    if(!source.empty() && source.size() != n){
+      report_error("Vector of known sources is not the same size as the "
+                   "PointProcess in MMPP::most_likely_states.");
+    }
+    process_info_->evaluate(process, source);
+    // The initial distribution is uniform, as in initialize_filter.
+    ViterbiRecursion viterbi;
+    viterbi.initialize(Vector(S, -log(S)));
+    // Everything about event t is in the transition, so there is no
+    // separate emission density.
+    Vector zero(S, 0.0);
+    Vector log_joint;
+    Matrix log_transition(S, S);
+    for(int t = 0; t < n; ++t){
+      fill_log_joint(t, *process_info_, zero, log_joint);
+      log_transition = negative_infinity();
+      for(int k = 0; k < log_joint.size(); ++k){
+        log_transition(transitions_.from(k), transitions_.to(k)) = log_joint[k];
+      }
+      viterbi.update(log_transition, zero);
+    }
+    return viterbi.most_likely_path();
+  }
+
+  //----------------------------------------------------------------------
+  Matrix MMPP::state_probabilities(const PointProcess &process,
+                                   const SourceVector &source){
+    int S = hmm_state_space_size();
+    int n = process.number_of_events();
+    Matrix ans(n + 1, S);
+    if(n == 0){
+      ans.row(0) = 1.0 / S;
+      return ans;
+    }
+    filter(process, source);
+    Vector pi(pi0_);
+    Vector ratio(S);
+    ans.row(n) = pi;
+    // The sparse analog of bkwd_1.  On entry filter_[t] is the joint
+    // distribution of states t-1 and t given events up to t, and pi
+    // is the smoothed distribution of state t.
+    for(int t = n - 1; t >= 0; --t){
+      Vector &P(filter_[t]);
+      ratio = 0.0;
+      for(int k = 0; k < P.size(); ++k){
+        ratio[transitions_.to(k)] += P[k];
+      }
+      for(int s = 0; s < S; ++s){
+        ratio[s] = ratio[s] > 0 ? pi[s] / ratio[s] : 0;
+      }
+      pi = 0.0;
+      for(int k = 0; k < P.size(); ++k){
+        P[k] *= ratio[transitions_.to(k)];
+        pi[transitions_.from(k)] += P[k];
+      }
+      ans.row(t) = pi;
+    }
+    return ans;
   }
 
   //----------------------------------------------------------------------
@@ -701,9 +1073,10 @@ namespace BOOM{
       update_exposure_time(process, n, current_state);
 
       for(int t = n - 1; t >= 0; --t){
-        int previous_state = draw_previous_state(rng, t, current_state);
-        PoissonProcess *responsible_process = sample_responsible_process(
-            rng, previous_state, current_state, *process_info_, t);
+        int k = draw_incoming_transition(rng, t, current_state);
+        int previous_state = transitions_.from(k);
+        PoissonProcess *responsible_process = sample_culprit(
+            rng, k, *process_info_, t);
         update_exposure_time(process, t, previous_state);
         const PointProcessEvent &event(process.event(t));
         responsible_process->add_event(event.timestamp());
@@ -842,21 +1215,25 @@ namespace BOOM{
   //   t:  The time index corresponding to 'current_state'.
   //   current_state:  The index of the HMM state at time t.
   int MMPP::draw_previous_state(RNG &rng, int t, int current_state_id){
-    const HmmState *current_state = hmm_states_[current_state_id].get();
-    const std::vector<HmmState *> & potential_values(
-        current_state->potential_incoming_transitions());
-    if(potential_values.size() == 1){
-      return potential_values.front()->id_number();
+    return transitions_.from(
+        draw_incoming_transition(rng, t, current_state_id));
+  }
+
+  int MMPP::draw_incoming_transition(RNG &rng, int t, int current_state){
+    int begin = transitions_.incoming_begin(current_state);
+    int end = transitions_.incoming_end(current_state);
+    if(end - begin == 1){
+      return transitions_.incoming_transition(begin);
     }
-    mutable_workspace_.resize(potential_values.size());
-    VectorView probs(filter_[t].col(current_state_id));
-    for(int i = 0; i < potential_values.size(); ++i){
-      mutable_workspace_[i] = probs[potential_values[i]->id_number()];
+    const Vector &probs(filter_[t]);
+    mutable_workspace_.resize(end - begin);
+    for(int j = begin; j < end; ++j){
+      mutable_workspace_[j - begin] = probs[transitions_.incoming_transition(j)];
     }
     mutable_workspace_.normalize_prob();
     int which_potential_value = rmulti_mt(rng, mutable_workspace_);
-    return potential_values[which_potential_value]->id_number();
-   }
+    return transitions_.incoming_transition(begin + which_potential_value);
+  }
 
   // Return the PoissonProcess responsible for the transition from
   // 'previous_state' to 'current_state.'
@@ -878,23 +1255,31 @@ namespace BOOM{
       int current_state_id,
       const ProcessInfo &process_info,
       int t){
-    const HmmState *previous_state(hmm_states_[previous_state_id].get());
-    const HmmState *current_state(hmm_states_[current_state_id].get());
-    const std::vector<PoissonProcess *> & potential_culprits(
-        previous_state->processes_transitioning_to(current_state));
+    int k = transitions_.find(previous_state_id, current_state_id);
+    if(k < 0){
+      report_error("Impossible transition passed to "
+                   "MMPP::sample_responsible_process.");
+    }
+    return sample_culprit(rng, k, process_info, t);
+  }
 
-    if(potential_culprits.size() == 1){
-      return potential_culprits[0];
+  PoissonProcess * MMPP::sample_culprit(RNG &rng,
+                                        int k,
+                                        const ProcessInfo &process_info,
+                                        int t){
+    int begin = transitions_.culprits_begin(k);
+    int end = transitions_.culprits_end(k);
+    if(end - begin == 1){
+      return transitions_.culprit(begin);
     }
-    mutable_workspace_.resize(potential_culprits.size());
-    for(int i = 0; i < potential_culprits.size(); ++i){
-      mutable_workspace_[i] =
-          process_info.log_event_rate(potential_culprits[i], t)
-          + process_info.mixture_log_likelihood(potential_culprits[i], t);
+    mutable_workspace_.resize(end - begin);
+    for(int j = begin; j < end; ++j){
+      mutable_workspace_[j - begin] =
+          transitions_.culprit_log_density(j, t, process_info);
     }
     mutable_workspace_.normalize_logprob();
     int index = rmulti_mt(rng, mutable_workspace_);
-    return potential_culprits[index];
+    return transitions_.culprit(begin + index);
   }
 
   //----------------------------------------------------------------------
@@ -1035,19 +1420,15 @@ namespace BOOM{
     pi0_.resize(S);
     pi0_ = 1.0 / S;
 
-    if(one_.size() != S){
-      one_.resize(S);
-      one_ = 1.0;
-    }
-
+    // Filter storage is one element per legal transition, rather
+    // than an S x S matrix.
+    int K = transitions_.number_of_transitions();
     while(filter_.size() < data.number_of_events()){
-      Matrix P(S, S);
-      filter_.push_back(P);
+      filter_.push_back(Vector(K));
     }
-
-    if(nrow(filter_[0]) < S){
+    if(filter_[0].size() != K){
       for(int i = 0; i < filter_.size(); ++i){
-        filter_[i].resize(S, S);
+        filter_[i].resize(K);
       }
     }
     return loglike;
@@ -1067,6 +1448,7 @@ namespace BOOM{
       }
     }
     process_info_.reset(new ProcessInfo(processes, mixture_components));
+    transitions_ = TransitionGraph(hmm_states_, *process_info_);
   }
 
 }
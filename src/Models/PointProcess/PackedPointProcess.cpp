@@ -0,0 +1,97 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <Models/PointProcess/PackedPointProcess.hpp>
+#include <cpputil/report_error.hpp>
+
+namespace BOOM{
+
+  namespace {
+    const double seconds_per_day = 86400.0;
+  }
+
+  int hour_of_week(const DateTime &time){
+    return 24 * time.date().day_of_week() + time.hour();
+  }
+
+  double days_since_epoch(const DateTime &time){
+    return time.date().days_after_jan_1_1970()
+        + time.seconds_into_day() / seconds_per_day;
+  }
+
+  //======================================================================
+  PackedPointProcess::PackedPointProcess()
+      : begin_hour_of_week_(BOOM::hour_of_week(begin_)),
+        begin_time_to_next_hour_(begin_.time_to_next_hour())
+  {
+    end_ = begin_;
+  }
+
+  PackedPointProcess::PackedPointProcess(const PointProcess &process)
+      : begin_(process.window_begin()),
+        end_(process.window_end()),
+        begin_hour_of_week_(BOOM::hour_of_week(begin_)),
+        begin_time_to_next_hour_(begin_.time_to_next_hour())
+  {
+    int n = process.number_of_events();
+    times_.reserve(n);
+    hour_of_week_.reserve(n);
+    for(int i = 0; i < n; ++i){
+      const PointProcessEvent &event(process.event(i));
+      const DateTime &timestamp(event.timestamp());
+      times_.push_back(days_since_epoch(timestamp));
+      hour_of_week_.push_back(BOOM::hour_of_week(timestamp));
+      if(event.has_mark()){
+        // The mark column is only allocated once a marked event is
+        // seen.
+        if(marks_.empty()) marks_.resize(n);
+        marks_[i] = event.mark_ptr();
+      }
+    }
+  }
+
+  DateTime PackedPointProcess::timestamp(int i)const{
+    return DateTime(times_[i], DateTime::day_scale);
+  }
+
+  const Data * PackedPointProcess::mark(int i)const{
+    return marks_.empty() ? 0 : marks_[i].get();
+  }
+
+  Ptr<Data> PackedPointProcess::mark_ptr(int i)const{
+    return marks_.empty() ? Ptr<Data>() : marks_[i];
+  }
+
+  PointProcess PackedPointProcess::unpack()const{
+    PointProcess ans(begin_, end_);
+    for(int i = 0; i < number_of_events(); ++i){
+      // Rounding in timestamp() can push an event a hair outside the
+      // observation window, so clamp it to the window endpoints.
+      DateTime t = timestamp(i);
+      if(t < begin_) t = begin_;
+      if(end_ < t) t = end_;
+      if(marks_.empty() || !marks_[i]){
+        ans.add_event(t);
+      }else{
+        ans.add_event(t, marks_[i]);
+      }
+    }
+    return ans;
+  }
+
+}  // namespace BOOM
@@ -23,6 +23,10 @@
 #include <cpputil/math_utils.hpp>
 #include <cpputil/lse.hpp>
 
+#ifndef NO_BOOST_THREADS
+#include <boost/thread.hpp>
+#endif
+
 namespace BOOM{
 
   namespace{
@@ -82,6 +86,68 @@ namespace BOOM{
       return std::pair<int, int>(i1, i2);
     }
 
+    // Imputes the latent data for every stride'th data series,
+    // starting with 'first'.  The imputed data are attributed to the
+    // components of 'worker', which must be a clone of the model that
+    // owns the data.
+    class PoissonClusterImputer {
+     public:
+      PoissonClusterImputer(
+          PoissonClusterProcess *worker,
+          const std::vector<Ptr<PointProcess> > &data,
+          const std::vector<const std::vector<int> *> &sources,
+          std::vector<Mat> &probability_of_activity,
+          std::vector<Mat> &probability_of_responsibility,
+          int first,
+          int stride,
+          unsigned long seed)
+          : worker_(worker),
+            data_(&data),
+            sources_(&sources),
+            activity_(&probability_of_activity),
+            responsibility_(&probability_of_responsibility),
+            first_(first),
+            stride_(stride),
+            rng_(seed),
+            loglike_(0)
+      {}
+
+      void operator()(){
+        try{
+          for(int i = first_; i < data_->size(); i += stride_){
+            const PointProcess &process(*(*data_)[i]);
+            const std::vector<int> &source(*(*sources_)[i]);
+            loglike_ += worker_->filter(process, source);
+            worker_->backward_sampling(rng_,
+                                       process,
+                                       source,
+                                       (*activity_)[i],
+                                       (*responsibility_)[i]);
+          }
+        }catch(const std::exception &e){
+          error_message_ = e.what();
+        }catch(...){
+          error_message_ =
+              "Unknown exception while imputing a PoissonClusterProcess.";
+        }
+      }
+
+      double loglike()const{return loglike_;}
+      const std::string &error_message()const{return error_message_;}
+
+     private:
+      PoissonClusterProcess *worker_;
+      const std::vector<Ptr<PointProcess> > *data_;
+      const std::vector<const std::vector<int> *> *sources_;
+      std::vector<Mat> *activity_;
+      std::vector<Mat> *responsibility_;
+      int first_;
+      int stride_;
+      RNG rng_;
+      double loglike_;
+      std::string error_message_;
+    };
+
   }  // unnamed namespace
 
   PoissonClusterProcess::PoissonClusterProcess(
@@ -169,6 +235,12 @@ namespace BOOM{
 
   //----------------------------------------------------------------------
   void PoissonClusterProcess::impute_latent_data(RNG &rng){
+#ifndef NO_BOOST_THREADS
+    if(!workers_.empty()){
+      impute_latent_data_with_threads(rng);
+      return;
+    }
+#endif
     const std::vector<Ptr<PointProcess> > &data(dat());
     last_loglike_ = 0;
     clear_client_data();
@@ -188,6 +260,86 @@ namespace BOOM{
     }
   }
 
+  //----------------------------------------------------------------------
+  void PoissonClusterProcess::set_nthreads(int n){
+    workers_.clear();
+#ifndef NO_BOOST_THREADS
+    if(n <= 1) return;
+    for(int i = 0; i < n; ++i){
+      Ptr<PoissonClusterProcess> worker(clone());
+      worker->clear_data();
+      workers_.push_back(worker);
+    }
+#endif
+  }
+
+  int PoissonClusterProcess::nthreads()const{
+    return workers_.empty() ? 1 : workers_.size();
+  }
+
+  //----------------------------------------------------------------------
+  // Each worker filters and samples a disjoint subset of the data
+  // series, writing directly into that series' probability_of_
+  // matrices.  The data attributed to the workers' components are
+  // then combined into the components of this model.
+  void PoissonClusterProcess::impute_latent_data_with_threads(RNG &rng){
+#ifndef NO_BOOST_THREADS
+    const std::vector<Ptr<PointProcess> > &data(dat());
+    last_loglike_ = 0;
+    clear_client_data();
+    std::vector<int> empty_source;
+    std::vector<const std::vector<int> *> sources(data.size());
+    for(int i = 0; i < data.size(); ++i){
+      SourceMap::const_iterator it = known_source_store_.find(data[i]);
+      sources[i] = it == known_source_store_.end() ? &empty_source
+          : &it->second;
+    }
+
+    int nworkers = workers_.size();
+    Vector params = vectorize_params();
+    std::vector<PoissonClusterImputer> imputers;
+    imputers.reserve(nworkers);
+    for(int w = 0; w < nworkers; ++w){
+      workers_[w]->unvectorize_params(params);
+      workers_[w]->clear_client_data();
+      imputers.push_back(PoissonClusterImputer(
+          workers_[w].get(), data, sources,
+          probability_of_activity_, probability_of_responsibility_,
+          w, nworkers, seed_rng(rng)));
+    }
+    boost::thread_group tg;
+    for(int w = 0; w < nworkers; ++w){
+      tg.add_thread(new boost::thread(boost::ref(imputers[w])));
+    }
+    tg.join_all();
+
+    for(int w = 0; w < nworkers; ++w){
+      if(!imputers[w].error_message().empty()){
+        report_error(imputers[w].error_message());
+      }
+      last_loglike_ += imputers[w].loglike();
+      combine_client_data(*workers_[w]);
+    }
+#endif
+  }
+
+  //----------------------------------------------------------------------
+  void PoissonClusterProcess::combine_client_data(
+      const PoissonClusterProcess &worker){
+    background_->combine_data(*worker.background_, true);
+    primary_birth_->combine_data(*worker.primary_birth_, true);
+    primary_death_->combine_data(*worker.primary_death_, true);
+    primary_traffic_->combine_data(*worker.primary_traffic_, true);
+    secondary_traffic_->combine_data(*worker.secondary_traffic_, true);
+    secondary_death_->combine_data(*worker.secondary_death_, true);
+    if(!!primary_mark_model_){
+      primary_mark_model_->combine_data(*worker.primary_mark_model_, true);
+    }
+    if(!!secondary_mark_model_){
+      secondary_mark_model_->combine_data(*worker.secondary_mark_model_, true);
+    }
+  }
+
   //----------------------------------------------------------------------
   void PoissonClusterProcess::sample_client_posterior(){
     background_->sample_posterior();
@@ -0,0 +1,30 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <Models/PointProcess/PoissonProcess.hpp>
+
+namespace BOOM{
+
+  void PoissonProcess::add_data_raw(const PackedPointProcess &data){
+    add_exposure_window(data.window_begin(), data.window_end());
+    for(int i = 0; i < data.number_of_events(); ++i){
+      add_event(data.timestamp(i));
+    }
+  }
+
+}  // namespace BOOM
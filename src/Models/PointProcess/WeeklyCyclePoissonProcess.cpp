@@ -49,10 +49,7 @@ namespace BOOM{
   void WS::Update(const PointProcess &data){
     // Incrementing event counts is easy...
     for(int i = 0; i < data.number_of_events(); ++i) {
-      const DateTime &event(data.event(i).timestamp());
-      DayNames day = event.date().day_of_week();
-      int hour = event.hour();
-      ++count_(day, hour);
+      add_event(data.event(i).timestamp());
     }
 
     // Increment exposure by integrating over the observation window.
@@ -61,14 +58,36 @@ namespace BOOM{
     add_exposure_window(window_begin, window_end);
   }
   //----------------------------------------------------------------------
+  void WS::Update(const PackedPointProcess &data){
+    const std::vector<unsigned char> &hours(data.hours_of_week());
+    for(int i = 0; i < hours.size(); ++i) {
+      add_event(hours[i]);
+    }
+    increment_exposure(data.window_begin_hour_of_week(),
+                       data.window_begin_time_to_next_hour(),
+                       data.window_duration());
+  }
+  //----------------------------------------------------------------------
   void WS::add_event(const DateTime &event){
-    ++count_(event.date().day_of_week(), event.hour());
+    add_event(hour_of_week(event));
+  }
+  //----------------------------------------------------------------------
+  // count_ is a 7 x 24 column-major matrix, so element (day, hour)
+  // lives at position day + 7 * hour.
+  void WS::add_event(int hour_of_week){
+    ++count_.data()[hour_of_week / 24 + 7 * (hour_of_week % 24)];
   }
   //----------------------------------------------------------------------
   void WS::add_exposure_window(const DateTime &window_begin,
                                const DateTime &window_end){
-    double duration = window_end - window_begin;
-
+    increment_exposure(hour_of_week(window_begin),
+                       window_begin.time_to_next_hour(),
+                       window_end - window_begin);
+  }
+  //----------------------------------------------------------------------
+  void WS::increment_exposure(int hour_of_week,
+                              double time_to_next_hour,
+                              double duration){
     // Define some constants.
     const double one_hour = DateTime::hours_to_days(1.0);
     const double one_week = 7.0;
@@ -83,22 +102,23 @@ namespace BOOM{
       }
     }
 
-    // What remains is an interation over at most 168 time buckets.
-    double time_to_next_hour = window_begin.time_to_next_hour();
+    // What remains is an interation over at most 168 time buckets,
+    // walking through exposure_ by position rather than by (day,
+    // hour).
+    double *exposure = exposure_.data();
+    int day = hour_of_week / 24;
+    int hour = hour_of_week % 24;
     double dt = std::min<double>(duration, time_to_next_hour);
-    DayNames day = window_begin.date().day_of_week();
-    int hour = window_begin.hour();
     while(duration > 0){
-      exposure_(day, hour) += dt;
+      exposure[day + 7 * hour] += dt;
       duration -= dt;
       ++hour;
       if(hour == 24){
         hour = 0;
-        day = next(day);
+        day = (day + 1) % 7;
       }
       dt = std::min<double>(one_hour, duration);
     }
-
   }
   //----------------------------------------------------------------------
 
@@ -475,6 +495,10 @@ namespace BOOM{
       suf()->Update(data);
     }
 
+    void WP::add_data_raw(const PackedPointProcess &data){
+      suf()->Update(data);
+    }
+
   void WP::add_exposure_window(const DateTime &t0, const DateTime &t1){
     suf()->add_exposure_window(t0, t1);
   }
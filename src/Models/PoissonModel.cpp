@@ -184,6 +184,25 @@ namespace BOOM{
     return dpois(DAT(dp)->value(), lam(), logscale); }
   double PoissonModel::pdf(const Data * dp, bool logscale) const{
     return dpois(DAT(dp)->value(), lam(), logscale); }
+  void PoissonModel::fill_logp(const std::vector<Ptr<Data> > &data,
+                               int start,
+                               VectorView ans)const{
+    double lambda = lam();
+    if(lambda <= 0){
+      MixtureComponent::fill_logp(data, start, ans);
+      return;
+    }
+    double log_lambda = log(lambda);
+    for(int i = 0; i < ans.size(); ++i){
+      const Data *dp = data[start + i].get();
+      if(dp->missing()){
+        ans[i] = 0;
+      }else{
+        double y = DAT(dp)->value();
+        ans[i] = y * log_lambda - lambda - lgamma(y + 1);
+      }
+    }
+  }
   double PoissonModel::mean()const{return lam();}
   double PoissonModel::var()const{return lam();}
   double PoissonModel::sd()const{return sqrt(lam());}
@@ -17,6 +17,7 @@
 */
 #include <Models/Policies/PriorPolicy.hpp>
 #include <Models/PosteriorSamplers/PosteriorSampler.hpp>
+#include <LinAlg/Workspace.hpp>
 
 
 namespace BOOM{
@@ -28,6 +29,15 @@ namespace BOOM{
 
 
   void PP::sample_posterior(){
+    if(recycle_temporaries_){
+      WorkspaceRegion region;
+      draw_samplers();
+    } else {
+      draw_samplers();
+    }
+  }
+
+  void PP::draw_samplers(){
     for(uint i=0; i<samplers_.size(); ++i){
       samplers_[i]->draw();
     }
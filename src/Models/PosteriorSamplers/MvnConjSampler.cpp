@@ -82,7 +82,10 @@ namespace BOOM{
     set_posterior_sufficient_statistics();
     SS = rWish(DF, SS.inv());// check this.. inverse?
     mod_->set_siginv(SS);
-    mu_hat = rmvn_mt(rng(), mu_hat, mod_->Sigma()/(n+k));
+    // Draw mu given its precision, SS * (n + k), which costs one
+    // factorization instead of inverting SS and then factoring the
+    // inverse.
+    mu_hat = rmvn_ivar_mt(rng(), mu_hat, SS * (n + k));
     mod_->set_mu(mu_hat);
   }
 
@@ -0,0 +1,537 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <Models/StateSpace/Filters/ParticleFilter.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <tuple>
+
+#include <distributions.hpp>
+#include <cpputil/math_utils.hpp>
+#include <cpputil/report_error.hpp>
+#include <stats/logit.hpp>
+
+#ifndef NO_BOOST_THREADS
+#include <boost/thread.hpp>
+#endif
+
+namespace BOOM {
+
+  namespace {
+    typedef StateSpaceParticleFilter SSPF;
+
+    // Returns a matrix L with L * L^T = V.  V may be singular (as
+    // with state models that have deterministic components), so
+    // small negative eigenvalues from rounding are set to zero.
+    Matrix variance_root(const SpdMatrix &V) {
+      Matrix eigenvectors(V.nrow(), V.nrow());
+      Vector eigenvalues = eigen(V, eigenvectors);
+      for (int i = 0; i < eigenvalues.size(); ++i) {
+        eigenvectors.col(i) *= sqrt(std::max<double>(eigenvalues[i], 0));
+      }
+      return eigenvectors;
+    }
+  }  // namespace
+
+  //======================================================================
+  // Runs one stage of the filter on a contiguous block of particles.
+  class SSPF::Worker {
+   public:
+    Worker(SSPF *filter, Stage stage, int begin, int end, RNG *rng)
+        : filter_(filter),
+          stage_(stage),
+          begin_(begin),
+          end_(end),
+          rng_(rng)
+    {}
+
+    void operator()() {
+      try {
+        if (stage_ == PROPAGATE) {
+          filter_->propagate(begin_, end_, *rng_);
+        } else {
+          filter_->move(begin_, end_, *rng_);
+        }
+      } catch(const std::exception &e) {
+        error_message_ = e.what();
+      } catch(...) {
+        error_message_ = "Unknown exception in StateSpaceParticleFilter.";
+      }
+    }
+
+    const std::string &error_message() const {return error_message_;}
+
+   private:
+    SSPF *filter_;
+    Stage stage_;
+    int begin_;
+    int end_;
+    RNG *rng_;
+    std::string error_message_;
+  };
+
+  //======================================================================
+  SSPF::StateSpaceParticleFilter(StateSpaceNormalMixture *model,
+                                 int number_of_particles,
+                                 RNG &seeding_rng)
+      : model_(model),
+        particles_(model->state_dimension(), number_of_particles, 0.0),
+        predicted_mean_(model->state_dimension(), number_of_particles, 0.0),
+        weights_(number_of_particles, 1.0 / number_of_particles),
+        log_observation_density_(number_of_particles, 0.0),
+        time_(0),
+        needs_propagation_(false),
+        have_observation_(false),
+        transition_(nullptr),
+        observation_vector_variance_(0),
+        regression_contribution_(0),
+        resampling_threshold_(.5),
+        number_of_move_steps_(1),
+        log_likelihood_(0),
+        number_of_resampling_events_(0),
+        rngs_(1, RNG(seed_rng(seeding_rng)))
+  {
+    if (number_of_particles < 1) {
+      report_error("A StateSpaceParticleFilter needs at least one particle.");
+    }
+  }
+
+  //----------------------------------------------------------------------
+  void SSPF::initialize(const Matrix &state_draws, int time) {
+    if (state_draws.ncol() != model_->state_dimension()) {
+      std::ostringstream err;
+      err << "The state draws passed to StateSpaceParticleFilter::initialize "
+          << "have " << state_draws.ncol() << " columns, but the model has "
+          << "state dimension " << model_->state_dimension() << ".";
+      report_error(err.str());
+    }
+    if (state_draws.nrow() == 0) {
+      report_error("No state draws passed to "
+                   "StateSpaceParticleFilter::initialize.");
+    }
+    if (time < 1) {
+      report_error("The time index passed to StateSpaceParticleFilter::"
+                   "initialize must be positive.  Use initialize_from_prior "
+                   "to start the filter at time 0.");
+    }
+    for (int i = 0; i < number_of_particles(); ++i) {
+      particles_.col(i) = state_draws.row(i % state_draws.nrow());
+    }
+    time_ = time;
+    needs_propagation_ = true;
+    reset();
+  }
+
+  //----------------------------------------------------------------------
+  void SSPF::initialize_from_prior() {
+    Vector mean = model_->initial_state_mean();
+    state_error_variance_ = model_->initial_state_variance();
+    state_error_root_ = variance_root(state_error_variance_);
+    Vector u(mean.size());
+    for (int i = 0; i < number_of_particles(); ++i) {
+      for (int j = 0; j < u.size(); ++j) u[j] = rnorm_mt(rngs_[0]);
+      predicted_mean_.col(i) = mean;
+      VectorView alpha(particles_.col(i));
+      alpha = mean;
+      alpha += state_error_root_ * u;
+    }
+    time_ = 0;
+    needs_propagation_ = false;
+    reset();
+  }
+
+  //----------------------------------------------------------------------
+  void SSPF::reset() {
+    weights_ = 1.0 / number_of_particles();
+    log_likelihood_ = 0;
+    number_of_resampling_events_ = 0;
+  }
+
+  //----------------------------------------------------------------------
+  void SSPF::set_number_of_threads(int n) {
+    n = std::max<int>(n, 1);
+#ifdef NO_BOOST_THREADS
+    n = 1;
+#endif
+    while (rngs_.size() > n) rngs_.pop_back();
+    while (rngs_.size() < n) rngs_.push_back(RNG(seed_rng(rngs_[0])));
+  }
+
+  //----------------------------------------------------------------------
+  void SSPF::set_resampling_threshold(double fraction) {
+    if (fraction < 0 || fraction > 1) {
+      report_error("The resampling threshold must be in [0, 1].");
+    }
+    resampling_threshold_ = fraction;
+  }
+
+  //----------------------------------------------------------------------
+  void SSPF::set_number_of_move_steps(int n) {
+    number_of_move_steps_ = std::max<int>(n, 0);
+  }
+
+  //----------------------------------------------------------------------
+  double SSPF::effective_sample_size() const {
+    return 1.0 / weights_.normsq();
+  }
+
+  //----------------------------------------------------------------------
+  Vector SSPF::filtered_state_mean() const {
+    return particles_ * weights_;
+  }
+
+  //----------------------------------------------------------------------
+  SpdMatrix SSPF::filtered_state_variance() const {
+    Vector mean = filtered_state_mean();
+    SpdMatrix ans(mean.size(), 0.0);
+    for (int i = 0; i < number_of_particles(); ++i) {
+      Vector error = particles_.col(i) - mean;
+      ans.add_outer(error, weights_[i], false);
+    }
+    ans.reflect();
+    return ans;
+  }
+
+  //----------------------------------------------------------------------
+  void SSPF::skip_observation() {
+    if (needs_propagation_) {
+      prepare_transition();
+      have_observation_ = false;
+      process_particles(PROPAGATE);
+    }
+    needs_propagation_ = true;
+    ++time_;
+  }
+
+  //----------------------------------------------------------------------
+  double SSPF::process_observation(double regression_contribution) {
+    if (needs_propagation_) prepare_transition();
+    regression_contribution_ = regression_contribution;
+    observation_vector_ = model_->observation_matrix(time_);
+    variance_times_observation_vector_ =
+        state_error_variance_ * observation_vector_;
+    observation_vector_variance_ =
+        observation_vector_.dot(variance_times_observation_vector_);
+    have_observation_ = true;
+    process_particles(PROPAGATE);
+    needs_propagation_ = true;
+
+    // Reweight.  The log predictive density is log sum_i w_i p(y | i),
+    // computed relative to the largest density to avoid underflow.
+    double max_log_density = max(log_observation_density_);
+    if (!std::isfinite(max_log_density)) {
+      std::ostringstream err;
+      err << "All particles have zero (or undefined) likelihood for "
+          << "the observation at time " << time_
+          << " in StateSpaceParticleFilter.";
+      report_error(err.str());
+    }
+    double total = 0;
+    for (int i = 0; i < number_of_particles(); ++i) {
+      weights_[i] *= exp(log_observation_density_[i] - max_log_density);
+      total += weights_[i];
+    }
+    weights_ /= total;
+    double log_predictive_density = max_log_density + log(total);
+    log_likelihood_ += log_predictive_density;
+
+    if (effective_sample_size()
+        < resampling_threshold_ * number_of_particles()) {
+      resample();
+      for (int step = 0; step < number_of_move_steps_; ++step) {
+        process_particles(MOVE);
+      }
+    }
+    ++time_;
+    return log_predictive_density;
+  }
+
+  //----------------------------------------------------------------------
+  void SSPF::prepare_transition() {
+    transition_ = model_->state_transition_matrix(time_ - 1);
+    state_error_variance_ = SpdMatrix(
+        model_->state_variance_matrix(time_ - 1)->dense());
+    state_error_root_ = variance_root(state_error_variance_);
+  }
+
+  //----------------------------------------------------------------------
+  void SSPF::propagate(int begin, int end, RNG &rng) {
+    Vector u(model_->state_dimension());
+    for (int i = begin; i < end; ++i) {
+      VectorView alpha(particles_.col(i));
+      if (needs_propagation_) {
+        VectorView predicted_mean(predicted_mean_.col(i));
+        predicted_mean = (*transition_) * alpha;
+        for (int j = 0; j < u.size(); ++j) u[j] = rnorm_mt(rng);
+        alpha = predicted_mean;
+        alpha += state_error_root_ * u;
+      }
+      if (have_observation_) {
+        log_observation_density_[i] = log_observation_density(
+            regression_contribution_ + observation_vector_.dot(alpha));
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------
+  // Given the previous state, the state is N(predicted_mean, V), and
+  // the latent observation is N(Z'state + regression, latent_variance).
+  // The conditional draw uses the fact that if (state*, latent*) is a
+  // draw from the joint distribution then
+  //
+  //   state* + V Z (latent - latent*) / (Z'VZ + latent_variance)
+  //
+  // is a draw from the distribution of the state given the latent
+  // observation.  This avoids factoring a matrix for each particle.
+  void SSPF::move(int begin, int end, RNG &rng) {
+    Vector u(model_->state_dimension());
+    Vector prior_draw(model_->state_dimension());
+    for (int i = begin; i < end; ++i) {
+      VectorView alpha(particles_.col(i));
+      double latent_value = 0;
+      double latent_variance = 0;
+      impute_latent_observation(
+          rng,
+          regression_contribution_ + observation_vector_.dot(alpha),
+          &latent_value,
+          &latent_variance);
+
+      for (int j = 0; j < u.size(); ++j) u[j] = rnorm_mt(rng);
+      prior_draw = predicted_mean_.col(i);
+      prior_draw += state_error_root_ * u;
+      double simulated_latent = regression_contribution_
+          + observation_vector_.dot(prior_draw)
+          + rnorm_mt(rng, 0, sqrt(latent_variance));
+      double gain = (latent_value - simulated_latent)
+          / (observation_vector_variance_ + latent_variance);
+      alpha = prior_draw;
+      alpha.axpy(variance_times_observation_vector_, gain);
+    }
+  }
+
+  //----------------------------------------------------------------------
+  void SSPF::process_particles(Stage stage) {
+    int nparticles = number_of_particles();
+    int nthreads = std::min<int>(rngs_.size(), nparticles);
+    if (nthreads <= 1) {
+      Worker worker(this, stage, 0, nparticles, &rngs_[0]);
+      worker();
+      if (!worker.error_message().empty()) {
+        report_error(worker.error_message());
+      }
+      return;
+    }
+#ifndef NO_BOOST_THREADS
+    int begin = 0;
+    if (stage == MOVE) {
+      // Some data imputers (e.g. PoissonDataImputer) fill a shared
+      // cache the first time they see a response value, so the first
+      // particle is moved before the other threads start.
+      move(0, 1, rngs_[0]);
+      begin = 1;
+    }
+    std::vector<Worker> workers;
+    workers.reserve(nthreads);
+    int chunk_size = (nparticles - begin + nthreads - 1) / nthreads;
+    for (int w = 0; w < nthreads; ++w) {
+      int end = std::min<int>(begin + chunk_size, nparticles);
+      workers.push_back(Worker(this, stage, begin, end, &rngs_[w]));
+      begin = end;
+    }
+    boost::thread_group tg;
+    for (int w = 0; w < nthreads; ++w) {
+      tg.add_thread(new boost::thread(boost::ref(workers[w])));
+    }
+    tg.join_all();
+    for (int w = 0; w < nthreads; ++w) {
+      if (!workers[w].error_message().empty()) {
+        report_error(workers[w].error_message());
+      }
+    }
+#endif
+  }
+
+  //----------------------------------------------------------------------
+  // Systematic resampling: a single uniform draw places N evenly
+  // spaced points on the cumulative weights.
+  void SSPF::resample() {
+    int nparticles = number_of_particles();
+    Matrix old_particles = particles_;
+    Matrix old_predicted_mean = predicted_mean_;
+    double step = 1.0 / nparticles;
+    double u = runif_mt(rngs_[0], 0, step);
+    double cumulative_weight = weights_[0];
+    int source = 0;
+    for (int i = 0; i < nparticles; ++i) {
+      while (u > cumulative_weight && source + 1 < nparticles) {
+        cumulative_weight += weights_[++source];
+      }
+      particles_.col(i) = old_particles.col(source);
+      predicted_mean_.col(i) = old_predicted_mean.col(source);
+      u += step;
+    }
+    weights_ = step;
+    ++number_of_resampling_events_;
+  }
+
+  //======================================================================
+  StateSpaceLogitParticleFilter::StateSpaceLogitParticleFilter(
+      StateSpaceLogitModel *model,
+      int number_of_particles,
+      RNG &seeding_rng,
+      int clt_threshold)
+      : StateSpaceParticleFilter(model, number_of_particles, seeding_rng),
+        model_(model),
+        data_imputer_(clt_threshold),
+        successes_(0),
+        trials_(0),
+        log_binomial_coefficient_(0)
+  {}
+
+  double StateSpaceLogitParticleFilter::update(
+      double successes, double trials, const Vector &predictors) {
+    if (successes < 0 || successes > trials) {
+      report_error("Illegal binomial observation passed to "
+                   "StateSpaceLogitParticleFilter::update.");
+    }
+    successes_ = successes;
+    trials_ = trials;
+    log_binomial_coefficient_ = lgamma(trials + 1) - lgamma(successes + 1)
+        - lgamma(trials - successes + 1);
+    return process_observation(model_->observation_model()->predict(
+        predictors));
+  }
+
+  double StateSpaceLogitParticleFilter::log_observation_density(
+      double linear_predictor) const {
+    return log_binomial_coefficient_ + successes_ * linear_predictor
+        - trials_ * lope(linear_predictor);
+  }
+
+  void StateSpaceLogitParticleFilter::impute_latent_observation(
+      RNG &rng, double linear_predictor, double *value, double *variance) {
+    double precision_weighted_sum = 0;
+    double total_precision = 0;
+    std::tie(precision_weighted_sum, total_precision) = data_imputer_.impute(
+        rng, trials_, successes_, linear_predictor);
+    *value = precision_weighted_sum / total_precision;
+    *variance = 1.0 / total_precision;
+  }
+
+  //======================================================================
+  StateSpacePoissonParticleFilter::StateSpacePoissonParticleFilter(
+      StateSpacePoissonModel *model,
+      int number_of_particles,
+      RNG &seeding_rng)
+      : StateSpaceParticleFilter(model, number_of_particles, seeding_rng),
+        model_(model),
+        count_(0),
+        exposure_(1)
+  {}
+
+  double StateSpacePoissonParticleFilter::update(
+      double count, double exposure, const Vector &predictors) {
+    if (count < 0 || exposure <= 0) {
+      report_error("Illegal Poisson observation passed to "
+                   "StateSpacePoissonParticleFilter::update.");
+    }
+    count_ = count;
+    exposure_ = exposure;
+    return process_observation(model_->observation_model()->predict(
+        predictors));
+  }
+
+  double StateSpacePoissonParticleFilter::log_observation_density(
+      double linear_predictor) const {
+    return dpois(count_, exposure_ * exp(linear_predictor), true);
+  }
+
+  // The latent data are formed in the same way as in
+  // StateSpacePoissonPosteriorSampler::impute_nonstate_latent_data.
+  void StateSpacePoissonParticleFilter::impute_latent_observation(
+      RNG &rng, double linear_predictor, double *value, double *variance) {
+    double internal_neglog_final_event_time = 0;
+    double internal_mixture_mean = 0;
+    double internal_mixture_precision = 0;
+    double neglog_final_interarrival_time = 0;
+    double external_mixture_mean = 0;
+    double external_mixture_precision = 0;
+    data_imputer_.impute(
+        rng,
+        lround(count_),
+        exposure_,
+        linear_predictor,
+        &internal_neglog_final_event_time,
+        &internal_mixture_mean,
+        &internal_mixture_precision,
+        &neglog_final_interarrival_time,
+        &external_mixture_mean,
+        &external_mixture_precision);
+
+    double total_precision = external_mixture_precision;
+    double precision_weighted_sum =
+        neglog_final_interarrival_time - external_mixture_mean;
+    precision_weighted_sum *= external_mixture_precision;
+    if (count_ > 0) {
+      precision_weighted_sum +=
+          (internal_neglog_final_event_time - internal_mixture_mean)
+          * internal_mixture_precision;
+      total_precision += internal_mixture_precision;
+    }
+    *value = precision_weighted_sum / total_precision;
+    *variance = 1.0 / total_precision;
+  }
+
+  //======================================================================
+  StateSpaceStudentParticleFilter::StateSpaceStudentParticleFilter(
+      StateSpaceStudentRegressionModel *model,
+      int number_of_particles,
+      RNG &seeding_rng)
+      : StateSpaceParticleFilter(model, number_of_particles, seeding_rng),
+        model_(model),
+        y_(0),
+        sigma_(1),
+        nu_(1)
+  {}
+
+  double StateSpaceStudentParticleFilter::update(
+      double y, const Vector &predictors) {
+    y_ = y;
+    sigma_ = model_->observation_model()->sigma();
+    nu_ = model_->observation_model()->nu();
+    return process_observation(model_->observation_model()->predict(
+        predictors));
+  }
+
+  double StateSpaceStudentParticleFilter::log_observation_density(
+      double linear_predictor) const {
+    return dstudent(y_, linear_predictor, sigma_, nu_, true);
+  }
+
+  // Given the latent weight w, y is N(linear_predictor, sigma^2 / w).
+  void StateSpaceStudentParticleFilter::impute_latent_observation(
+      RNG &rng, double linear_predictor, double *value, double *variance) {
+    double weight = data_imputer_.impute(
+        rng, y_ - linear_predictor, sigma_, nu_);
+    *value = y_;
+    *variance = square(sigma_) / weight;
+  }
+
+}  // namespace BOOM
@@ -19,6 +19,7 @@
 #include <Models/StateSpace/StateModels/Holiday.hpp>
 #include <Models/StateSpace/StateModels/RandomWalkHolidayStateModel.hpp>
 #include <distributions.hpp>
+#include <algorithm>
 
 namespace BOOM {
   typedef RandomWalkHolidayStateModel RWHSM;
@@ -43,10 +44,8 @@ namespace BOOM {
   void RWHSM::observe_state(const ConstVectorView then,
                             const ConstVectorView now,
                             int time_now){
-    Date today = time_zero_ + time_now;
-    if(holiday_->active(today)){
-      Date holiday_date = holiday_->nearest(today);
-      int position = today - holiday_->earliest_influence(holiday_date);
+    int position = window_position(time_now);
+    if(position >= 0){
       double delta = now[position] - then[position];
       suf()->update_raw(delta);
     }
@@ -57,11 +56,9 @@ namespace BOOM {
   }
 
   void RWHSM::simulate_state_error(VectorView eta, int t)const{
-    Date now = time_zero_ + t;
     eta = 0;
-    if(holiday_->active(now)){
-      Date holiday_date(holiday_->nearest(now));
-      int position = now - holiday_->earliest_influence(holiday_date);
+    int position = window_position(t);
+    if(position >= 0){
       eta[position] = rnorm(0, sigma());
     }
   }
@@ -71,21 +68,17 @@ namespace BOOM {
   }
 
   Ptr<SparseMatrixBlock> RWHSM::state_variance_matrix(int t)const{
-    Date now = time_zero_ + t;
-    if(holiday_->active(now)){
-      Date holiday_date(holiday_->nearest(now));
-      int position = now - holiday_->earliest_influence(holiday_date);
+    int position = window_position(t);
+    if(position >= 0){
       return active_state_variance_matrix_[position];
     }
     return zero_state_variance_matrix_;
   }
 
   SparseVector RWHSM::observation_matrix(int t)const{
-    Date now = time_zero_ + t;
     SparseVector ans(state_dimension());
-    if(holiday_->active(now)){
-      Date holiday_date(holiday_->nearest(now));
-      int position = now - holiday_->earliest_influence(holiday_date);
+    int position = window_position(t);
+    if(position >= 0){
       ans[position] = 1.0;
     }
     return ans;
@@ -116,6 +109,35 @@ namespace BOOM {
 
   void RWHSM::set_time_zero(const Date &time_zero){
     time_zero_ = time_zero;
+    window_position_.clear();
+  }
+
+  int RWHSM::window_position(int t)const{
+    if(t < 0){
+      Date now = time_zero_ + t;
+      if(!holiday_->active(now)) return -1;
+      return now - holiday_->earliest_influence(holiday_->nearest(now));
+    }
+    if(t >= window_position_.size()) extend_window_positions(t);
+    return window_position_[t];
+  }
+
+  // The table grows by at least a year at a time, and the Date is
+  // advanced incrementally, so each new entry costs one call to
+  // Holiday::active().
+  void RWHSM::extend_window_positions(int t)const{
+    int old_size = window_position_.size();
+    int new_size = std::max<int>(t + 1, old_size + 366);
+    window_position_.resize(new_size);
+    Date now = time_zero_ + old_size;
+    for(int s = old_size; s < new_size; ++s, ++now){
+      if(holiday_->active(now)){
+        window_position_[s] =
+            now - holiday_->earliest_influence(holiday_->nearest(now));
+      }else{
+        window_position_[s] = -1;
+      }
+    }
   }
 
 }  // namespace BOOM
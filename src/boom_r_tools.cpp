@@ -251,6 +251,59 @@ namespace BOOM{
     return ans;
   }
 
+  //======================================================================
+  RNumericMemory::Preserver::Preserver(SEXP r_object)
+      : r_object_(r_object)
+  {
+    R_PreserveObject(r_object_);
+  }
+
+  RNumericMemory::Preserver::~Preserver() {
+    R_ReleaseObject(r_object_);
+  }
+
+  RNumericMemory::RNumericMemory(SEXP r_object)
+      : is_copy_(TYPEOF(r_object) != REALSXP)
+  {
+    if (is_copy_) {
+      r_object = Rf_coerceVector(r_object, REALSXP);
+    }
+    // Preserving the object before any further allocation keeps the
+    // coerced copy (if any) safe from the garbage collector.
+    preserver_.reset(new Preserver(r_object));
+    data_ = REAL(r_object);
+    length_ = Rf_length(r_object);
+  }
+
+  namespace {
+    SEXP CheckNumeric(SEXP r_vector) {
+      if (!Rf_isNumeric(r_vector)) {
+        report_error("RVectorView called with a non-numeric argument.");
+      }
+      return r_vector;
+    }
+
+    SEXP CheckMatrix(SEXP r_matrix) {
+      if (!Rf_isMatrix(r_matrix)) {
+        report_error("RMatrixView called with a non-matrix argument.");
+      }
+      return r_matrix;
+    }
+  }  // namespace
+
+  RVectorView::RVectorView(SEXP r_vector)
+      : RNumericMemory(CheckNumeric(r_vector))
+  {}
+
+  RMatrixView::RMatrixView(SEXP r_matrix)
+      : RNumericMemory(CheckMatrix(r_matrix))
+  {
+    std::pair<int, int> dims = GetMatrixDimensions(r_matrix);
+    nrow_ = dims.first;
+    ncol_ = dims.second;
+  }
+
+  //======================================================================
   Matrix ToBoomMatrix(SEXP m){
     return Matrix(ToBoomMatrixView(m));
   }
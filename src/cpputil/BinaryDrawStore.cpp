@@ -0,0 +1,421 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <cpputil/BinaryDrawStore.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <sstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cpputil/report_error.hpp>
+
+namespace BOOM {
+  namespace BinaryDrawStore {
+    namespace {
+      const char kMagic[] = "BOOMDRAW";
+      const int kMagicSize = 8;
+      const uint32_t kByteOrderMark = 0x01020304;
+      const uint32_t kFormatVersion = 1;
+
+      void put_uint32(uint32_t value, std::ostream &out) {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+      }
+
+      // Reads a uint32 at *pos, and advances *pos.  Returns false if
+      // there are not enough bytes remaining.
+      bool get_uint32(const char **pos, const char *end, uint32_t *value) {
+        if (end - *pos < static_cast<std::ptrdiff_t>(sizeof(uint32_t))) {
+          return false;
+        }
+        std::memcpy(value, *pos, sizeof(uint32_t));
+        *pos += sizeof(uint32_t);
+        return true;
+      }
+
+      uint32_t require_uint32(const char **pos, const char *end) {
+        uint32_t ans;
+        if (!get_uint32(pos, end, &ans)) {
+          report_error("Truncated header in binary draw file.");
+        }
+        return ans;
+      }
+    }  // namespace
+
+    std::size_t ColumnInfo::bytes_per_draw() const {
+      return dim * (storage == FLOAT_STORAGE ? sizeof(float) : sizeof(double));
+    }
+
+    //======================================================================
+    MappedFile::MappedFile(const std::string &filename)
+        : data_(NULL),
+          size_(0),
+          mapped_(false)
+    {
+#ifndef _WIN32
+      int fd = ::open(filename.c_str(), O_RDONLY);
+      if (fd >= 0) {
+        struct stat file_status;
+        if (::fstat(fd, &file_status) == 0 && file_status.st_size > 0) {
+          void *address = ::mmap(NULL, file_status.st_size, PROT_READ,
+                                 MAP_SHARED, fd, 0);
+          if (address != MAP_FAILED) {
+            data_ = static_cast<const char *>(address);
+            size_ = file_status.st_size;
+            mapped_ = true;
+          }
+        }
+        ::close(fd);
+        if (mapped_) return;
+      }
+#endif
+      std::ifstream input(filename.c_str(), std::ios::binary);
+      if (!input) {
+        report_error("Could not open binary draw file " + filename);
+      }
+      buffer_.assign(std::istreambuf_iterator<char>(input),
+                     std::istreambuf_iterator<char>());
+      data_ = buffer_.empty() ? NULL : &buffer_[0];
+      size_ = buffer_.size();
+    }
+
+    MappedFile::~MappedFile() {
+#ifndef _WIN32
+      if (mapped_) {
+        ::munmap(const_cast<char *>(data_), size_);
+      }
+#endif
+    }
+
+    //======================================================================
+    Writer::Writer(const std::string &filename,
+                   const std::vector<ColumnInfo> &columns,
+                   int chunk_size_in_iterations)
+        : output_(filename.c_str(), std::ios::binary | std::ios::trunc),
+          columns_(columns),
+          chunk_size_(chunk_size_in_iterations),
+          number_of_draws_(0),
+          iterations_in_chunk_(0)
+    {
+      if (!output_) {
+        report_error("Could not open binary draw file " + filename);
+      }
+      if (chunk_size_ <= 0) {
+        report_error("Chunk size must be positive in BinaryDrawStore.");
+      }
+      for (int i = 0; i < columns_.size(); ++i) {
+        if (columns_[i].storage != DOUBLE_STORAGE
+            && columns_[i].storage != FLOAT_STORAGE) {
+          report_error("Unknown storage type for column '"
+                       + columns_[i].name + "' in BinaryDrawStore.");
+        }
+        chunk_buffers_.push_back(Vector(chunk_size_ * columns_[i].dim, 0.0));
+      }
+      write_header();
+      output_.flush();
+    }
+
+    Writer::~Writer() {
+      flush();
+    }
+
+    void Writer::set(int column, const ConstVectorView &draw) {
+      const ColumnInfo &info(columns_[column]);
+      if (draw.size() != info.dim) {
+        std::ostringstream err;
+        err << "Draw of size " << draw.size() << " written to column '"
+            << info.name << "' of dimension " << info.dim << ".";
+        report_error(err.str());
+      }
+      VectorView(chunk_buffers_[column],
+                 iterations_in_chunk_ * info.dim, info.dim) = draw;
+    }
+
+    void Writer::end_iteration() {
+      ++number_of_draws_;
+      if (++iterations_in_chunk_ >= chunk_size_) {
+        flush();
+      }
+    }
+
+    void Writer::write_header() {
+      output_.write(kMagic, kMagicSize);
+      put_uint32(kByteOrderMark, output_);
+      put_uint32(kFormatVersion, output_);
+      put_uint32(columns_.size(), output_);
+      for (int i = 0; i < columns_.size(); ++i) {
+        put_uint32(columns_[i].name.size(), output_);
+        output_.write(columns_[i].name.data(), columns_[i].name.size());
+        put_uint32(columns_[i].dim, output_);
+        put_uint32(columns_[i].storage, output_);
+      }
+    }
+
+    void Writer::flush() {
+      if (iterations_in_chunk_ > 0) {
+        put_uint32(iterations_in_chunk_, output_);
+        std::vector<float> float_buffer;
+        for (int i = 0; i < columns_.size(); ++i) {
+          int n = iterations_in_chunk_ * columns_[i].dim;
+          const double *values = chunk_buffers_[i].data();
+          if (columns_[i].storage == FLOAT_STORAGE) {
+            float_buffer.assign(values, values + n);
+            output_.write(reinterpret_cast<const char *>(float_buffer.data()),
+                          n * sizeof(float));
+          } else {
+            output_.write(reinterpret_cast<const char *>(values),
+                          n * sizeof(double));
+          }
+          chunk_buffers_[i] = 0.0;
+        }
+        iterations_in_chunk_ = 0;
+      }
+      output_.flush();
+    }
+
+    //======================================================================
+    Reader::Reader(const std::string &filename)
+        : file_(new MappedFile(filename)),
+          number_of_draws_(0)
+    {
+      const char *pos = file_->data();
+      const char *end = pos + file_->size();
+      if (file_->size() < kMagicSize
+          || std::memcmp(pos, kMagic, kMagicSize) != 0) {
+        report_error(filename + " is not a binary draw file.");
+      }
+      pos += kMagicSize;
+      if (require_uint32(&pos, end) != kByteOrderMark) {
+        report_error(filename + " was written on a machine with a "
+                     "different byte order.");
+      }
+      uint32_t version = require_uint32(&pos, end);
+      if (version != kFormatVersion) {
+        std::ostringstream err;
+        err << "Unsupported binary draw file version " << version
+            << " in " << filename << ".";
+        report_error(err.str());
+      }
+      uint32_t number_of_columns = require_uint32(&pos, end);
+      std::size_t bytes_per_iteration = 0;
+      for (int i = 0; i < number_of_columns; ++i) {
+        ColumnInfo info;
+        uint32_t name_length = require_uint32(&pos, end);
+        if (end - pos < name_length) {
+          report_error("Truncated header in binary draw file.");
+        }
+        info.name.assign(pos, name_length);
+        pos += name_length;
+        info.dim = require_uint32(&pos, end);
+        uint32_t storage = require_uint32(&pos, end);
+        if (storage != DOUBLE_STORAGE && storage != FLOAT_STORAGE) {
+          std::ostringstream err;
+          err << "Unknown storage type " << storage << " for column '"
+              << info.name << "' in binary draw file " << filename << ".";
+          report_error(err.str());
+        }
+        info.storage = static_cast<StorageType>(storage);
+        bytes_per_iteration += info.bytes_per_draw();
+        columns_.push_back(info);
+      }
+
+      // Index the chunks.  A partially written chunk at the end of the
+      // file is ignored.
+      uint32_t chunk_iterations;
+      while (get_uint32(&pos, end, &chunk_iterations)) {
+        std::size_t chunk_bytes = chunk_iterations * bytes_per_iteration;
+        if (end - pos < chunk_bytes) break;
+        chunk_offsets_.push_back(pos - file_->data());
+        chunk_start_.push_back(number_of_draws_);
+        chunk_size_.push_back(chunk_iterations);
+        number_of_draws_ += chunk_iterations;
+        pos += chunk_bytes;
+      }
+    }
+
+    int Reader::column_index(const std::string &name) const {
+      for (int i = 0; i < columns_.size(); ++i) {
+        if (columns_[i].name == name) return i;
+      }
+      return -1;
+    }
+
+    const char *Reader::column_data(int iteration, int column) const {
+      if (iteration < 0 || iteration >= number_of_draws_) {
+        std::ostringstream err;
+        err << "Iteration " << iteration << " requested from a binary draw "
+            << "file containing " << number_of_draws_ << " draws.";
+        report_error(err.str());
+      }
+      // Chunks are usually all the same size, so guess first, then
+      // fall back to a binary search.
+      int chunk = iteration / chunk_size_[0];
+      if (chunk >= chunk_start_.size()
+          || chunk_start_[chunk] > iteration
+          || chunk_start_[chunk] + chunk_size_[chunk] <= iteration) {
+        chunk = std::upper_bound(chunk_start_.begin(), chunk_start_.end(),
+                                 iteration) - chunk_start_.begin() - 1;
+      }
+      int niter = chunk_size_[chunk];
+      const char *ans = file_->data() + chunk_offsets_[chunk];
+      for (int i = 0; i < column; ++i) {
+        ans += niter * columns_[i].bytes_per_draw();
+      }
+      return ans + (iteration - chunk_start_[chunk])
+          * columns_[column].bytes_per_draw();
+    }
+
+    void Reader::read(int iteration, int column, VectorView out) const {
+      const ColumnInfo &info(columns_[column]);
+      if (out.size() != info.dim) {
+        report_error("Output buffer has the wrong size in "
+                     "BinaryDrawStore::Reader::read.");
+      }
+      const char *data = column_data(iteration, column);
+      if (info.storage == FLOAT_STORAGE) {
+        float value;
+        for (int i = 0; i < info.dim; ++i) {
+          std::memcpy(&value, data + i * sizeof(float), sizeof(float));
+          out[i] = value;
+        }
+      } else {
+        double value;
+        for (int i = 0; i < info.dim; ++i) {
+          std::memcpy(&value, data + i * sizeof(double), sizeof(double));
+          out[i] = value;
+        }
+      }
+    }
+
+    Vector Reader::draw(int iteration, int column) const {
+      Vector ans(columns_[column].dim);
+      read(iteration, column, VectorView(ans));
+      return ans;
+    }
+
+    Matrix Reader::column_draws(int column) const {
+      Matrix ans(number_of_draws_, columns_[column].dim);
+      for (int i = 0; i < number_of_draws_; ++i) {
+        read(i, column, ans.row(i));
+      }
+      return ans;
+    }
+  }  // namespace BinaryDrawStore
+
+  //======================================================================
+  BinaryParamIoManager::BinaryParamIoManager()
+      : position_(0)
+  {}
+
+  void BinaryParamIoManager::add_parameter(
+      Ptr<Params> parameter,
+      const std::string &name,
+      BinaryDrawStore::StorageType storage) {
+    if (writer_) {
+      report_error("Parameters must be added before calling "
+                   "prepare_to_write.");
+    }
+    parameters_.push_back(parameter);
+    names_.push_back(name);
+    storage_.push_back(storage);
+  }
+
+  void BinaryParamIoManager::prepare_to_write(
+      const std::string &filename, int chunk_size_in_iterations) {
+    reader_.reset();
+    std::vector<BinaryDrawStore::ColumnInfo> columns(parameters_.size());
+    for (int i = 0; i < parameters_.size(); ++i) {
+      columns[i].name = names_[i];
+      columns[i].dim = parameters_[i]->size(false);
+      columns[i].storage = storage_[i];
+    }
+    writer_.reset(new BinaryDrawStore::Writer(
+        filename, columns, chunk_size_in_iterations));
+  }
+
+  void BinaryParamIoManager::write() {
+    if (!writer_) {
+      report_error("Call prepare_to_write before write.");
+    }
+    for (int i = 0; i < parameters_.size(); ++i) {
+      writer_->set(i, parameters_[i]->vectorize(false));
+    }
+    writer_->end_iteration();
+  }
+
+  void BinaryParamIoManager::flush() {
+    if (writer_) writer_->flush();
+  }
+
+  void BinaryParamIoManager::prepare_to_stream(const std::string &filename) {
+    if (writer_) {
+      writer_->flush();
+      writer_.reset();
+    }
+    reader_.reset(new BinaryDrawStore::Reader(filename));
+    reader_columns_.resize(parameters_.size());
+    for (int i = 0; i < parameters_.size(); ++i) {
+      int column = reader_->column_index(names_[i]);
+      if (column < 0) {
+        report_error("Parameter '" + names_[i] +
+                     "' was not found in binary draw file " + filename);
+      }
+      if (reader_->column(column).dim != parameters_[i]->size(false)) {
+        report_error("Parameter '" + names_[i] + "' has a different "
+                     "dimension than its column in " + filename);
+      }
+      if (reader_->column(column).storage != storage_[i]) {
+        report_error("Parameter '" + names_[i] + "' has a different "
+                     "storage type than its column in " + filename);
+      }
+      reader_columns_[i] = column;
+    }
+    position_ = 0;
+  }
+
+  void BinaryParamIoManager::stream() {
+    if (!reader_) {
+      report_error("Call prepare_to_stream before stream.");
+    }
+    for (int i = 0; i < parameters_.size(); ++i) {
+      workspace_.resize(reader_->column(reader_columns_[i]).dim);
+      reader_->read(position_, reader_columns_[i], VectorView(workspace_));
+      parameters_[i]->unvectorize(workspace_, false);
+    }
+    ++position_;
+  }
+
+  void BinaryParamIoManager::advance(int n) {position_ += n;}
+
+  void BinaryParamIoManager::rewind() {position_ = 0;}
+
+  int BinaryParamIoManager::number_of_draws() const {
+    if (reader_) return reader_->number_of_draws();
+    if (writer_) return writer_->number_of_draws();
+    return 0;
+  }
+
+}  // namespace BOOM
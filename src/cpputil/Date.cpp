@@ -27,6 +27,42 @@
 
 namespace BOOM{
 
+  namespace {
+    // Conversions between civil dates and a day count, following
+    // Howard Hinnant's "days_from_civil" and "civil_from_days"
+    // algorithms (http://howardhinnant.github.io/date_algorithms.html).
+    // Years are shifted to start on March 1, so the leap day falls
+    // at the end of the year, and the calendar repeats every 400
+    // years (146097 days).  There are no loops or table searches,
+    // and dates before 1970 need no special handling.
+    long days_from_civil(int year, int month, int day){
+      year -= month <= 2;
+      const long era = (year >= 0 ? year : year - 399) / 400;
+      const int year_of_era = year - era * 400;                 // [0, 399]
+      const int day_of_year =
+          (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;  // [0, 365]
+      const int day_of_era = year_of_era * 365 + year_of_era / 4
+          - year_of_era / 100 + day_of_year;                    // [0, 146096]
+      // 719468 is the number of days from Mar 1, 0000 to Jan 1, 1970.
+      return era * 146097 + day_of_era - 719468;
+    }
+
+    void civil_from_days(long days, int *year, int *month, int *day){
+      days += 719468;
+      const long era = (days >= 0 ? days : days - 146096) / 146097;
+      const int day_of_era = days - era * 146097;               // [0, 146096]
+      const int year_of_era = (day_of_era - day_of_era / 1460
+                               + day_of_era / 36524
+                               - day_of_era / 146096) / 365;    // [0, 399]
+      const int day_of_year = day_of_era
+          - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+      const int shifted_month = (5 * day_of_year + 2) / 153;    // [0, 11]
+      *day = day_of_year - (153 * shifted_month + 2) / 5 + 1;
+      *month = shifted_month < 10 ? shifted_month + 3 : shifted_month - 9;
+      *year = year_of_era + era * 400 + (*month <= 2);
+    }
+  }  // namespace
+
   ostream & operator<<(ostream & out, const DayNames &d){
     if(d==Sat) out << "Saturday";
     else if(d==Sun) out << "Sunday";
@@ -80,37 +116,15 @@ namespace BOOM{
   }
 
   Date & Date::set(int days_after_jan_1_1970){
-    if(days_after_jan_1_1970 == 0) return set(Jan, 1, 1970);
     days_after_origin_ = days_after_jan_1_1970;
-    if(days_after_jan_1_1970 < 0){
-      return set_before_1970(-days_after_jan_1_1970);
-    }
-    int days_into_year;
-    year_ = 1970 + years_after_jan_1_1970(days_after_jan_1_1970, &days_into_year);
-    bool leap = is_leap_year(year_);
-    find_month_and_day(days_into_year, leap, &month_, &day_);
-    check(month_, day_, year_);
+    int month;
+    civil_from_days(days_after_jan_1_1970, &year_, &month, &day_);
+    month_ = MonthNames(month);
     return *this;
   }
 
   Date &Date::set_before_1970(int days_before){
-    if(days_before < 0) return set(-days_before);
-    days_after_origin_ = -days_before;
-    // year_delta is the number of complete years in days_before days.
-    int year_delta = years_before_jan_1_1970(days_before, &days_before);
-    year_ = 1970 -  year_delta;
-    // now days_before is the number of days before the start of year_;
-    if(days_before == 0){
-      month_ = Jan;
-      day_ = 1;
-      return *this;
-    }
-    --year_;      // Now year_ is the actual year of the Date object.
-    bool leap = is_leap_year(year_);
-    int days_into_year = 365 + leap - days_before;
-    find_month_and_day(days_into_year, leap, &month_, &day_);
-    check(month_, day_, year_);
-    return *this;
+    return set(-days_before);
   }
 
   void Date::find_month_and_day(int days_after_jan1, bool leap,
@@ -200,30 +214,13 @@ namespace BOOM{
   }
 
   int Date::days_after_jan_1_1970(MonthNames month, int day, int year){
-    if(year < 1970) return -1 * days_before_jan_1_1970(month, day, year);
-    int ans = 365 * (year - 1970) + number_of_leap_years_after_1970(year);
-    ans += days_into_year(month, day, is_leap_year(year));
-    // ans includes jan 1, 1970, so subtract it off before returning.
-    return ans - 1;
+    return days_from_civil(year, month, day);
   }
 
   // Compute the number of days that a particular date is before Jan
   // 1, 1970.
   int Date::days_before_jan_1_1970(MonthNames month, int day, int year){
-    if(year >= 1970) return -1*days_after_jan_1_1970(month, day, year);
-
-    // Compute the number of days needed to get to Jan 1 of next year
-    bool leap = is_leap_year(year);
-
-    // The number of days is the number of days until the end of the
-    // year plus the number of days in the complete years between Jan
-    // 1 next year and Jan 1 1970.
-    int days_to_jan1 =
-        366 + leap - days_into_year(month, day, leap);
-    ++year;
-    return days_to_jan1 + 365*(1970 - year) +
-        number_of_leap_years_before_1970(year) +
-        is_leap_year(year);
+    return -days_from_civil(year, month, day);
   }
 
   Date::Date(const string &m, int d, int yyyy)
@@ -361,8 +358,10 @@ namespace BOOM{
   DayNames Date::day_of_week()const{
     /////////////////////////////////////////////////////////
     // Jan 1 1970 was a Thursday.  Subtract 4
-    int day = days_after_origin_ % 7;
-    return DayNames( (day + 4) % 7);
+    // The C++ % operator can return negative values for dates before
+    // 1970, so shift those into [0, 7).
+    int day = (days_after_origin_ + 4) % 7;
+    return DayNames(day < 0 ? day + 7 : day);
   }
 
   time_t Date::to_time_t()const{
@@ -115,10 +115,10 @@ namespace BOOM{
 
     t_ -= days;
     if(t_<0){
-      double frac = rem(t_,1.0); // a negative number in (-1,0]
+      double frac = rem(t_,1.0); // the fraction of a day in [0, 1)
       long ndays = lround(floor(t_));  // a negative number <= t_
       d_ += ndays;
-      t_ = 1-frac;
+      t_ = frac;
     }
     return *this;
   }
@@ -0,0 +1,97 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <distributions/AliasTable.hpp>
+#include <distributions.hpp>
+#include <cpputil/report_error.hpp>
+#include <cmath>
+#include <sstream>
+
+namespace BOOM{
+
+  AliasTable::AliasTable() {}
+
+  AliasTable::AliasTable(const ConstVectorView &probabilities) {
+    set_probabilities(probabilities);
+  }
+
+  void AliasTable::set_probabilities(const ConstVectorView &probabilities) {
+    uint n = probabilities.size();
+    double total = 0;
+    for (uint i = 0; i < n; ++i) {
+      double p = probabilities[i];
+      if (!(p >= 0) || !std::isfinite(p)) {
+        std::ostringstream err;
+        err << "AliasTable needs non-negative, finite probabilities.  "
+            << "probabilities = " << probabilities << std::endl;
+        report_error(err.str());
+      }
+      total += p;
+    }
+    if (total <= 0) {
+      std::ostringstream err;
+      err << "AliasTable needs probabilities with a positive sum.  "
+          << "probabilities = " << probabilities << std::endl;
+      report_error(err.str());
+    }
+
+    // Scale so the average box holds 1.  Boxes with less than 1 are
+    // "small" and are topped up from a "large" box, which becomes the
+    // small box's alias.
+    cutoff_.resize(n);
+    alias_.resize(n);
+    small_.clear();
+    large_.clear();
+    double scale = n / total;
+    for (uint i = 0; i < n; ++i) {
+      cutoff_[i] = probabilities[i] * scale;
+      alias_[i] = i;
+      if (cutoff_[i] < 1.0) {
+        small_.push_back(i);
+      } else {
+        large_.push_back(i);
+      }
+    }
+    while (!small_.empty() && !large_.empty()) {
+      uint less = small_.back();
+      small_.pop_back();
+      uint more = large_.back();
+      alias_[less] = more;
+      cutoff_[more] -= 1.0 - cutoff_[less];
+      if (cutoff_[more] < 1.0) {
+        large_.pop_back();
+        small_.push_back(more);
+      }
+    }
+    // Whatever is left over is 1 up to rounding error.
+    for (uint i = 0; i < large_.size(); ++i) cutoff_[large_[i]] = 1.0;
+    for (uint i = 0; i < small_.size(); ++i) cutoff_[small_[i]] = 1.0;
+  }
+
+  uint AliasTable::draw(RNG &rng) const {
+    uint n = cutoff_.size();
+    if (n == 0) {
+      report_error("AliasTable::draw called on an empty table.");
+    }
+    double u = runif_mt(rng, 0, n);
+    uint box = static_cast<uint>(u);
+    if (box >= n) box = n - 1;
+    return (u - box) < cutoff_[box] ? box : alias_[box];
+  }
+
+}  // namespace BOOM
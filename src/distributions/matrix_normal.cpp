@@ -23,6 +23,7 @@
 #include <LinAlg/Vector.hpp>
 #include <LinAlg/Matrix.hpp>
 #include <LinAlg/Cholesky.hpp>
+#include <LinAlg/Kronecker.hpp>
 #include <LinAlg/SpdMatrix.hpp>
 #include <algorithm>
 
@@ -75,17 +76,11 @@ namespace BOOM{
   Matrix rmatrix_normal_ivar_mt(RNG & rng, const Matrix & Mu,
                              const SpdMatrix &Siginv, const SpdMatrix &Ominv){
 
-    uint xdim = Mu.nrow();
-    uint ydim = Mu.ncol();
-    Matrix Z(xdim,ydim);
-    double *zdata = Z.data();
-    for(uint i=0; i<xdim*ydim; ++i){ zdata[i] = rnorm_mt(rng); }
-
-    Matrix Ominv_U(t(Chol(Ominv).getL()));
-    Matrix Lsig(Linv(Chol(Siginv).getL()));
-
-    Matrix ans = Mu + Usolve(Ominv_U,Z) * Lsig;
-    return ans;
+    // vec(ans) ~ N(vec(Mu), (Siginv (x) Ominv)^{-1}).  The draw is
+    // computed with triangular solves on the Cholesky factors of Siginv
+    // and Ominv.
+    SpdKroneckerProduct precision(Siginv, Ominv);
+    return precision.rmvn_ivar(rng, Mu);
   }
 
 }
@@ -25,10 +25,46 @@
 #include <LinAlg/Matrix.hpp>
 #include <LinAlg/SpdMatrix.hpp>
 #include <LinAlg/Cholesky.hpp>
+#include <LinAlg/FixedMatrix.hpp>
 #include <algorithm>
 
 namespace BOOM{
 
+  namespace {
+    // Draws for dimensions up to max_fixed_matrix_dimension, with the
+    // Cholesky factor held on the stack.  If 'inverse' is true then
+    // 'V' is the inverse of the variance matrix.  Returns false if V
+    // is not positive definite, in which case 'ans' is unchanged.
+    template <int N>
+    bool rmvn_fixed(RNG &rng, const Vector &mu, const SpdMatrix &V,
+                    bool inverse, Vector &ans) {
+      FixedMatrix<N, N> spd(V);
+      FixedMatrix<N, N> L;
+      if (!fixed_cholesky(spd, L)) return false;
+      ans.resize(N);
+      for (int i = 0; i < N; ++i) ans[i] = rnorm_mt(rng, 0, 1);
+      if (inverse) {
+        // If ivar = L L^T then Sigma = L^{-T} L^{-1}.
+        fixed_LTsolve_inplace(L, VectorView(ans));
+      } else {
+        fixed_Lmult_inplace(L, VectorView(ans));
+      }
+      ans += mu;
+      return true;
+    }
+
+    bool rmvn_small(RNG &rng, const Vector &mu, const SpdMatrix &V,
+                    bool inverse, Vector &ans) {
+      switch (V.nrow()) {
+        case 1: return rmvn_fixed<1>(rng, mu, V, inverse, ans);
+        case 2: return rmvn_fixed<2>(rng, mu, V, inverse, ans);
+        case 3: return rmvn_fixed<3>(rng, mu, V, inverse, ans);
+        case 4: return rmvn_fixed<4>(rng, mu, V, inverse, ans);
+        default: return false;
+      }
+    }
+  }  // namespace
+
   Vector rmvn_robust(const Vector &mu, const SpdMatrix &V){
     return rmvn_robust_mt(GlobalRng::rng, mu, V); }
   Vector rmvn_robust_mt(RNG &rng, const Vector &mu, const SpdMatrix &V){
@@ -61,6 +97,8 @@ namespace BOOM{
     return rmvn_mt(GlobalRng::rng, mu, V); }
 
   Vector rmvn_mt(RNG & rng, const Vector &mu, const SpdMatrix &V){
+    Vector ans;
+    if(rmvn_small(rng, mu, V, false, ans)) return ans;
     bool okay=true;
     Matrix L = V.chol(okay);
     if(okay) return rmvn_L_mt(rng, mu, L);
@@ -73,8 +111,9 @@ namespace BOOM{
   Vector rmvn_ivar_mt(RNG & rng, const Vector &mu, const SpdMatrix &ivar){
     // draws a multivariate normal with mean mu and inverse variance
     // Matrix ivar
-    Matrix U= ivar.chol().t();  /////// experimental
-    return rmvn_ivar_U_mt(rng, mu, U);
+    Vector ans;
+    if(rmvn_small(rng, mu, ivar, true, ans)) return ans;
+    return rmvn_ivar_L_mt(rng, mu, Chol(ivar));
   }
 
   Vector rmvn_ivar_U(const Vector &mu, const Matrix &U){
@@ -93,7 +132,23 @@ namespace BOOM{
     return rmvn_ivar_L_mt(GlobalRng::rng, mu, L);  }
   Vector rmvn_ivar_L_mt(RNG & rng, const Vector &mu, const Matrix &L){
     // L is the lower cholesky triangle  of the inverse variance Matrix
-    return rmvn_ivar_U_mt(rng, mu, L.t());  }
+    uint n = mu.size();
+    Vector z(n);
+    for(uint i =0; i<n; ++i) z[i] = rnorm_mt(rng, 0,1);
+    LTsolve_inplace(L, z);
+    z += mu;
+    return z;
+  }
+
+  Vector rmvn_ivar_L_mt(RNG & rng, const Vector &mu, const Chol &ivar_chol){
+    uint n = mu.size();
+    Vector z(n);
+    for(uint i =0; i<n; ++i) z[i] = rnorm_mt(rng, 0,1);
+    //    if ivar = L L^T then Sigma = L^{-T} L^{-1}
+    ivar_chol.LTsolve_inplace(z);
+    z += mu;
+    return z;
+  }
 
 
   Vector rmvn_suf(const SpdMatrix & Ivar, const Vector & IvarMu){
@@ -104,7 +159,7 @@ namespace BOOM{
     uint n = IvarMu.size();
     Vector z(n);
     for(uint i=0; i<n; ++i) z[i] = rnorm_mt(rng);
-    LTsolve_inplace(L.getL(), z);  // returns LT^-1 z which is ~ N(0, Ivar.inv)
+    L.LTsolve_inplace(z);  // returns LT^-1 z which is ~ N(0, Ivar.inv)
     z+= L.solve(IvarMu);
     return z;
   }
@@ -22,6 +22,8 @@
 #include <LinAlg/Vector.hpp>
 #include <LinAlg/VectorView.hpp>
 
+#include <cpputil/lse.hpp>
+#include <cpputil/math_utils.hpp>
 #include <cpputil/report_error.hpp>
 #include <sstream>
 
@@ -80,6 +82,38 @@ namespace BOOM{
   uint rmulti_mt(RNG &rng, const VectorView &prob){ return rmulti_mt_impl(rng, prob); }
   uint rmulti_mt(RNG &rng, const ConstVectorView &prob){ return rmulti_mt_impl(rng, prob); }
 
+  uint rmulti_logprob_mt(RNG &rng, Vector &logprob,
+                         double *log_normalizing_constant) {
+    uint n = logprob.size();
+    double max_logprob = n > 0 ? logprob.max() : negative_infinity();
+    if (!std::isfinite(max_logprob)) {
+      std::ostringstream err;
+      err << "rmulti_logprob_mt needs at least one finite log probability.  "
+          << "logprob = " << logprob << endl;
+      report_error(err.str());
+    }
+    double *prob = logprob.data();
+    double total = exp_shifted(prob, max_logprob, prob, n);
+    if (log_normalizing_constant) {
+      *log_normalizing_constant = max_logprob + std::log(total);
+    }
+    double u = runif_mt(rng, 0, total);
+    // If rounding leaves u above the final partial sum, the draw goes
+    // to the last state with positive probability.
+    uint ans = n - 1;
+    double psum = 0;
+    for (uint i = 0; i < n; ++i) {
+      psum += prob[i];
+      if (u <= psum) {
+        ans = i;
+        break;
+      }
+    }
+    while (ans > 0 && prob[ans] <= 0) --ans;
+    logprob /= total;
+    return ans;
+  }
+
   uint rmulti(const Vector &prob){return rmulti_mt_impl(GlobalRng::rng, prob);}
   uint rmulti(const VectorView &prob){return rmulti_mt_impl(GlobalRng::rng, prob);}
   uint rmulti(const ConstVectorView &prob){return rmulti_mt_impl(GlobalRng::rng, prob);}
@@ -41,7 +41,7 @@ namespace BOOM {
      public:
       // rdata is a an R vector
       virtual std::vector<Ptr<Data> > Extract(SEXP rdata) const {
-        BOOM::Vector v = ToBoomVector(rdata);
+        RVectorView v(rdata);
         int n = v.size();
         std::vector<Ptr<Data> > ans;
         ans.reserve(n);
@@ -111,7 +111,7 @@ namespace BOOM {
      public:
       // rdata is a an R vector
       virtual std::vector<Ptr<Data> > Extract(SEXP rdata) const {
-        Vector v = ToBoomVector(rdata);
+        RVectorView v(rdata);
         int n = v.size();
         std::vector<Ptr<Data> > ans;
         ans.reserve(n);
@@ -130,8 +130,10 @@ namespace BOOM {
      public:
       // rdata is an R matrix with each row
       virtual std::vector<Ptr<Data> > Extract(SEXP rdata) const {
-        BOOM::Matrix y = ToBoomMatrix(rdata);
-        int n = nrow(y);
+        // Each row is copied directly from R's memory into its
+        // VectorData, without an intermediate BOOM::Matrix.
+        RMatrixView y(rdata);
+        int n = y.nrow();
         std::vector<Ptr<Data> > ans;
         ans.reserve(n);
         for (int i = 0; i < n; ++i) {
@@ -159,8 +161,8 @@ namespace BOOM {
       // rdata is a list that contains two elements: a vector named y and
       // a matrix named x.
       virtual std::vector<Ptr<Data> > Extract(SEXP rdata) const {
-        Vector y = ToBoomVector(getListElement(rdata, "y"));
-        Matrix x = ToBoomMatrix(getListElement(rdata, "x"));
+        RVectorView y(getListElement(rdata, "y"));
+        RMatrixView x(getListElement(rdata, "x"));
         int n = y.size();
         std::vector<Ptr<Data> > ans;
         ans.reserve(n);
@@ -193,8 +195,8 @@ namespace BOOM {
       virtual std::vector<Ptr<Data> > Extract(SEXP rdata) const {
         int *y = INTEGER(getListElement(rdata, "y"));
         int *n = INTEGER(getListElement(rdata, "n"));
-        Matrix x = ToBoomMatrix(getListElement(rdata, "x"));
-        int nobs = nrow(x);
+        RMatrixView x(getListElement(rdata, "x"));
+        int nobs = x.nrow();
         std::vector<Ptr<Data> > ans;
         ans.reserve(nobs);
         for (int i = 0; i < nobs; ++i) {
@@ -202,7 +204,7 @@ namespace BOOM {
           bool n_is_missing(n[i] == NA_INTEGER);
           int missing_preditors = count_missing(x.row(i));
           Ptr<Data> dp = new BinomialRegressionData(y[i], n[i], x.row(i));
-          if((y_is_missing || n_is_missing) && missing_preditors == ncol(x)) {
+          if((y_is_missing || n_is_missing) && missing_preditors == x.ncol()) {
             dp->set_missing_status(BOOM::Data::completely_missing);
           } else if(y_is_missing || n_is_missing || missing_preditors > 0) {
             dp->set_missing_status(BOOM::Data::partly_missing);
@@ -9,18 +9,34 @@
 
 namespace BOOM {
 
+  RListIoManager::RListIoManager()
+      : thin_(1),
+        iteration_(0)
+  {}
+
   void RListIoManager::add_list_element(RListIoElement *element) {
     elements_.push_back(boost::shared_ptr<RListIoElement>(element));
   }
 
+  void RListIoManager::set_thinning(int thin) {
+    if (thin < 1) {
+      report_error("Thinning interval must be at least 1.");
+    }
+    thin_ = thin;
+  }
+
   SEXP RListIoManager::prepare_to_write(int niter) {
     SEXP ans;
     SEXP param_names;
+    iteration_ = 0;
+    int number_of_stored_draws = (niter + thin_ - 1) / thin_;
     PROTECT(ans = Rf_allocVector(VECSXP, elements_.size()));
     PROTECT(param_names = Rf_allocVector(STRSXP, elements_.size()));
     for (int i = 0; i < elements_.size(); ++i) {
       SET_VECTOR_ELT(ans, i,
-                     elements_[i]->prepare_to_write(niter));
+                     elements_[i]->prepare_to_write(
+                         elements_[i]->summarizes_draws() ?
+                         niter : number_of_stored_draws));
       SET_STRING_ELT(param_names, i,
                      Rf_mkChar(elements_[i]->name().c_str()));
     }
@@ -37,8 +53,11 @@ namespace BOOM {
   }
 
   void RListIoManager::write() {
+    bool record = (iteration_++ % thin_) == 0;
     for (int i = 0; i < elements_.size(); ++i) {
-      elements_[i]->write();
+      if (record || elements_[i]->summarizes_draws()) {
+        elements_[i]->write();
+      }
     }
   }
 
@@ -54,6 +73,26 @@ namespace BOOM {
     }
   }
 
+  SEXP BinaryDrawsToRMatrix(const BinaryDrawStore::Reader &reader,
+                            const std::string &column_name) {
+    int column = reader.column_index(column_name);
+    if (column < 0) {
+      report_error("No column named '" + column_name +
+                   "' in the binary draw file.");
+    }
+    int niter = reader.number_of_draws();
+    int dim = reader.column(column).dim;
+    SEXP ans = PROTECT(Rf_allocMatrix(REALSXP, niter, dim));
+    // R matrices are stored in column-major order, so each draw is a
+    // strided row of the R buffer.
+    double *data = REAL(ans);
+    for (int i = 0; i < niter; ++i) {
+      reader.read(i, column, VectorView(data + i, dim, niter));
+    }
+    UNPROTECT(1);
+    return ans;
+  }
+
   //======================================================================
   RListIoElement::RListIoElement(const std::string &name) : name_(name) {}
 
@@ -689,6 +728,116 @@ namespace BOOM {
     return callback_->ncol();
   }
 
+  //======================================================================
+  namespace {
+    // Returns an R array of doubles with the given dimensions.  A
+    // single dimension produces a plain R vector.
+    SEXP AllocateRealArray(const std::vector<int> &dims) {
+      if (dims.size() == 1) {
+        return Rf_allocVector(REALSXP, dims[0]);
+      }
+      SEXP r_dims;
+      PROTECT(r_dims = Rf_allocVector(INTSXP, dims.size()));
+      std::copy(dims.begin(), dims.end(), INTEGER(r_dims));
+      SEXP ans = Rf_allocArray(REALSXP, r_dims);
+      UNPROTECT(1);
+      return ans;
+    }
+  }  // namespace
+
+  SummaryListElement::SummaryListElement(VectorIoCallback *callback,
+                                         const std::string &name,
+                                         const Vector &quantile_probs,
+                                         int batch_size)
+      : RListIoElement(name),
+        vector_callback_(callback),
+        quantile_probs_(quantile_probs.begin(), quantile_probs.end()),
+        batch_size_(batch_size),
+        niter_(0)
+  {}
+
+  SummaryListElement::SummaryListElement(MatrixIoCallback *callback,
+                                         const std::string &name,
+                                         const Vector &quantile_probs,
+                                         int batch_size)
+      : RListIoElement(name),
+        matrix_callback_(callback),
+        quantile_probs_(quantile_probs.begin(), quantile_probs.end()),
+        batch_size_(batch_size),
+        niter_(0)
+  {}
+
+  Vector SummaryListElement::current_draw() const {
+    if (vector_callback_) {
+      return vector_callback_->get_vector();
+    } else {
+      // Matrices are stored in column major order, which matches R.
+      Matrix draw = matrix_callback_->get_matrix();
+      return Vector(draw.begin(), draw.end());
+    }
+  }
+
+  SEXP SummaryListElement::prepare_to_write(int niter) {
+    if (!vector_callback_ && !matrix_callback_) {
+      report_error("NULL callback in SummaryListElement::prepare_to_write");
+    }
+    niter_ = niter;
+    dims_.clear();
+    if (vector_callback_) {
+      dims_.push_back(vector_callback_->dim());
+    } else {
+      dims_.push_back(matrix_callback_->nrow());
+      dims_.push_back(matrix_callback_->ncol());
+    }
+    int dim = 1;
+    for (int i = 0; i < dims_.size(); ++i) dim *= dims_[i];
+    summary_.reset(new StreamingSummary(dim, batch_size_, quantile_probs_));
+
+    std::vector<int> quantile_dims(dims_);
+    quantile_dims.push_back(quantile_probs_.size());
+    std::vector<SEXP> elements;
+    std::vector<std::string> names;
+    elements.push_back(PROTECT(AllocateRealArray(dims_)));
+    names.push_back("mean");
+    elements.push_back(PROTECT(AllocateRealArray(dims_)));
+    names.push_back("variance");
+    elements.push_back(PROTECT(AllocateRealArray(quantile_dims)));
+    names.push_back("quantiles");
+    elements.push_back(PROTECT(AllocateRealArray(dims_)));
+    names.push_back("effective.sample.size");
+    elements.push_back(PROTECT(Rf_allocVector(REALSXP, 1)));
+    names.push_back("draws");
+    SEXP ans = PROTECT(CreateList(elements, names));
+    StoreBuffer(ans);
+    fill_buffer();
+    UNPROTECT(6);
+    return ans;
+  }
+
+  void SummaryListElement::write() {
+    summary_->update(current_draw());
+    int n = summary_->number_of_draws();
+    if (n % batch_size_ == 0 || n == niter_) {
+      fill_buffer();
+    }
+  }
+
+  void SummaryListElement::fill_buffer() {
+    SEXP buffer = rbuffer();
+    const Vector &mean(summary_->mean());
+    std::copy(mean.begin(), mean.end(), REAL(VECTOR_ELT(buffer, 0)));
+    Vector variance = summary_->variance();
+    std::copy(variance.begin(), variance.end(), REAL(VECTOR_ELT(buffer, 1)));
+    if (!quantile_probs_.empty()) {
+      Matrix quantiles = summary_->quantiles();
+      std::copy(quantiles.begin(), quantiles.end(),
+                REAL(VECTOR_ELT(buffer, 2)));
+    }
+    Vector ess = summary_->effective_sample_size();
+    std::copy(ess.begin(), ess.end(), REAL(VECTOR_ELT(buffer, 3)));
+    REAL(VECTOR_ELT(buffer, 4))[0] = summary_->number_of_draws();
+  }
+
   //======================================================================
   NativeArrayListElement::NativeArrayListElement(ArrayIoCallback *callback,
                                                  const std::string &name)
@@ -0,0 +1,202 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <stats/QuantileSketch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include <cpputil/report_error.hpp>
+
+namespace BOOM {
+
+  namespace {
+    // The ratio between the capacities of adjacent compactors.
+    const double kCapacityRatio = 2.0 / 3.0;
+  }  // namespace
+
+  QuantileSketch::QuantileSketch(int accuracy)
+      : accuracy_(accuracy),
+        nobs_(0),
+        min_(std::numeric_limits<double>::infinity()),
+        max_(-std::numeric_limits<double>::infinity()),
+        retained_size_(0),
+        table_is_current_(false)
+  {
+    if (accuracy_ < 8) {
+      report_error("QuantileSketch accuracy must be at least 8.");
+    }
+    add_level();
+  }
+
+  void QuantileSketch::clear() {
+    nobs_ = 0;
+    min_ = std::numeric_limits<double>::infinity();
+    max_ = -std::numeric_limits<double>::infinity();
+    levels_.clear();
+    keep_odd_.clear();
+    retained_size_ = 0;
+    table_is_current_ = false;
+    add_level();
+  }
+
+  // Adding a level shrinks the capacities of all the levels below it,
+  // so the capacities are recomputed here rather than on every add().
+  void QuantileSketch::add_level() {
+    levels_.push_back(std::vector<double>());
+    keep_odd_.push_back(false);
+    int nlevels = levels_.size();
+    capacities_.resize(nlevels);
+    total_capacity_ = 0;
+    for (int h = 0; h < nlevels; ++h) {
+      int depth = nlevels - 1 - h;
+      capacities_[h] = std::max<int>(
+          2, std::ceil(accuracy_ * std::pow(kCapacityRatio, depth)));
+      total_capacity_ += capacities_[h];
+    }
+  }
+
+  void QuantileSketch::add(double x) {
+    levels_[0].push_back(x);
+    ++retained_size_;
+    ++nobs_;
+    min_ = std::min(min_, x);
+    max_ = std::max(max_, x);
+    table_is_current_ = false;
+    if (retained_size_ >= total_capacity_) {
+      compress();
+    }
+  }
+
+  // Compaction is lazy: individual levels may exceed their
+  // capacities, and nothing is compacted until the sketch as a whole
+  // is full.  Then the lowest over-full level is compacted, which
+  // amortizes the sorting cost over many calls to add().
+  void QuantileSketch::compress() {
+    while (retained_size_ >= total_capacity_) {
+      for (int h = 0; h < levels_.size(); ++h) {
+        if (levels_[h].size() >= capacities_[h]) {
+          compact(h);
+          break;
+        }
+      }
+    }
+  }
+
+  void QuantileSketch::compact(int level) {
+    if (level + 1 == levels_.size()) {
+      add_level();
+    }
+    std::vector<double> &values(levels_[level]);
+    std::sort(values.begin(), values.end());
+    // If there is an odd number of values, the largest one stays
+    // behind so that the promoted values pair up exactly.
+    int n = values.size();
+    double leftover = values.back();
+    bool has_leftover = n % 2 == 1;
+    if (has_leftover) --n;
+
+    std::vector<double> &next(levels_[level + 1]);
+    int offset = keep_odd_[level] ? 1 : 0;
+    keep_odd_[level] = !keep_odd_[level];
+    for (int i = offset; i < n; i += 2) {
+      next.push_back(values[i]);
+    }
+    retained_size_ -= n / 2;
+    values.clear();
+    if (has_leftover) values.push_back(leftover);
+  }
+
+  void QuantileSketch::combine(const QuantileSketch &rhs) {
+    if (rhs.nobs_ == 0) return;
+    if (&rhs == this) {
+      // Inserting a level into itself would invalidate the range
+      // being inserted.
+      QuantileSketch copy(rhs);
+      combine(copy);
+      return;
+    }
+    while (levels_.size() < rhs.levels_.size()) {
+      add_level();
+    }
+    for (int h = 0; h < rhs.levels_.size(); ++h) {
+      levels_[h].insert(levels_[h].end(),
+                        rhs.levels_[h].begin(), rhs.levels_[h].end());
+    }
+    retained_size_ += rhs.retained_size_;
+    nobs_ += rhs.nobs_;
+    min_ = std::min(min_, rhs.min_);
+    max_ = std::max(max_, rhs.max_);
+    table_is_current_ = false;
+    compress();
+  }
+
+  void QuantileSketch::update_cdf() const {
+    if (table_is_current_) return;
+    std::vector<std::pair<double, double> > weighted;
+    weighted.reserve(retained_size_);
+    double weight = 1.0;
+    for (int h = 0; h < levels_.size(); ++h) {
+      for (int i = 0; i < levels_[h].size(); ++i) {
+        weighted.push_back(std::make_pair(levels_[h][i], weight));
+      }
+      weight *= 2;
+    }
+    std::sort(weighted.begin(), weighted.end());
+    sorted_values_.resize(weighted.size());
+    cumulative_weights_.resize(weighted.size());
+    double total = 0;
+    for (int i = 0; i < weighted.size(); ++i) {
+      sorted_values_[i] = weighted[i].first;
+      total += weighted[i].second;
+      cumulative_weights_[i] = total;
+    }
+    table_is_current_ = true;
+  }
+
+  double QuantileSketch::quantile(double prob) const {
+    if (nobs_ == 0) {
+      report_error("QuantileSketch::quantile called on an empty sketch.");
+    }
+    if (prob <= 0) return min_;
+    if (prob >= 1) return max_;
+    update_cdf();
+    // Compaction preserves the number of observations exactly, so the
+    // total weight is nobs_.
+    double target = prob * cumulative_weights_.back();
+    int pos = std::lower_bound(cumulative_weights_.begin(),
+                               cumulative_weights_.end(),
+                               target) - cumulative_weights_.begin();
+    if (pos >= sorted_values_.size()) pos = sorted_values_.size() - 1;
+    return sorted_values_[pos];
+  }
+
+  double QuantileSketch::cdf(double x) const {
+    if (nobs_ == 0) return 0;
+    if (x < min_) return 0;
+    if (x >= max_) return 1;
+    update_cdf();
+    int pos = std::upper_bound(sorted_values_.begin(), sorted_values_.end(),
+                               x) - sorted_values_.begin();
+    if (pos == 0) return 0;
+    return cumulative_weights_[pos - 1] / cumulative_weights_.back();
+  }
+
+}  // namespace BOOM
@@ -0,0 +1,112 @@
+/*
+  Copyright (C) 2016 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <stats/StreamingSummary.hpp>
+#include <cpputil/report_error.hpp>
+#include <sstream>
+
+namespace BOOM {
+
+  StreamingSummary::StreamingSummary(
+      int dim, int batch_size, const std::vector<double> &quantile_probs)
+      : number_of_draws_(0),
+        mean_(dim, 0.0),
+        sum_of_squares_(dim, 0.0),
+        quantile_probs_(quantile_probs),
+        batch_size_(batch_size),
+        draws_in_current_batch_(0),
+        current_batch_sum_(dim, 0.0),
+        number_of_batches_(0),
+        batch_mean_mean_(dim, 0.0),
+        batch_mean_sum_of_squares_(dim, 0.0)
+  {
+    if (batch_size_ <= 0) {
+      report_error("batch_size must be positive in StreamingSummary.");
+    }
+    if (!quantile_probs_.empty()) {
+      quantile_sketches_.resize(dim);
+    }
+  }
+
+  void StreamingSummary::update(const ConstVectorView &draw) {
+    if (draw.size() != mean_.size()) {
+      std::ostringstream err;
+      err << "StreamingSummary of dimension " << mean_.size()
+          << " was passed a draw of size " << draw.size() << ".";
+      report_error(err.str());
+    }
+    ++number_of_draws_;
+    double n = number_of_draws_;
+    for (int i = 0; i < mean_.size(); ++i) {
+      double delta = draw[i] - mean_[i];
+      mean_[i] += delta / n;
+      sum_of_squares_[i] += delta * (draw[i] - mean_[i]);
+    }
+    for (int i = 0; i < quantile_sketches_.size(); ++i) {
+      quantile_sketches_[i].add(draw[i]);
+    }
+
+    current_batch_sum_ += draw;
+    if (++draws_in_current_batch_ == batch_size_) {
+      ++number_of_batches_;
+      double nb = number_of_batches_;
+      for (int i = 0; i < mean_.size(); ++i) {
+        double batch_mean = current_batch_sum_[i] / batch_size_;
+        double delta = batch_mean - batch_mean_mean_[i];
+        batch_mean_mean_[i] += delta / nb;
+        batch_mean_sum_of_squares_[i] +=
+            delta * (batch_mean - batch_mean_mean_[i]);
+      }
+      current_batch_sum_ = 0.0;
+      draws_in_current_batch_ = 0;
+    }
+  }
+
+  Vector StreamingSummary::variance() const {
+    if (number_of_draws_ < 2) {
+      return Vector(mean_.size(), 0.0);
+    }
+    return sum_of_squares_ / (number_of_draws_ - 1.0);
+  }
+
+  Matrix StreamingSummary::quantiles() const {
+    Matrix ans(mean_.size(), quantile_probs_.size());
+    if (number_of_draws_ == 0) return ans;
+    for (int i = 0; i < quantile_sketches_.size(); ++i) {
+      for (int j = 0; j < quantile_probs_.size(); ++j) {
+        ans(i, j) = quantile_sketches_[i].quantile(quantile_probs_[j]);
+      }
+    }
+    return ans;
+  }
+
+  Vector StreamingSummary::effective_sample_size() const {
+    Vector ans(mean_.size(), number_of_draws_);
+    if (number_of_batches_ < 2) return ans;
+    Vector v = variance();
+    for (int i = 0; i < mean_.size(); ++i) {
+      double batch_mean_variance =
+          batch_mean_sum_of_squares_[i] / (number_of_batches_ - 1.0);
+      if (batch_mean_variance > 0 && v[i] > 0) {
+        ans[i] = number_of_draws_ * v[i] / (batch_size_ * batch_mean_variance);
+      }
+    }
+    return ans;
+  }
+
+}  // namespace BOOM